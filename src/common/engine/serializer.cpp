@@ -118,18 +118,185 @@ const char *UnicodeToString(const char *cc)
 	return &out[0];
 }
 
+//==========================================================================
+//
+// Replays a binary stream written by FWriter into a rapidjson document.
+// Returns false if the buffer does not contain binary data.
+// Broken data results in an empty document, just like broken JSON.
+//
+//==========================================================================
+
+class FBinarySerializerReader
+{
+	const uint8_t *p;
+	const uint8_t *end;
+	TArray<std::pair<const char *, unsigned>> keys;
+
+	bool GetVarint(uint64_t &v)
+	{
+		v = 0;
+		for (int shift = 0; shift < 64 && p < end; shift += 7)
+		{
+			uint8_t b = *p++;
+			v |= uint64_t(b & 0x7f) << shift;
+			if (!(b & 0x80)) return true;
+		}
+		return false;
+	}
+
+	bool GetSigned(int64_t &v)
+	{
+		uint64_t u;
+		if (!GetVarint(u)) return false;
+		v = int64_t(u >> 1) ^ -int64_t(u & 1);
+		return true;
+	}
+
+	bool GetBytes(const char *&str, unsigned &len)
+	{
+		uint64_t v;
+		if (!GetVarint(v) || v > uint64_t(end - p)) return false;
+		str = (const char *)p;
+		len = (unsigned)v;
+		p += len;
+		return true;
+	}
+
+public:
+	FBinarySerializerReader(const uint8_t *buffer, size_t length)
+	{
+		p = buffer;
+		end = buffer + length;
+	}
+
+	template<class Handler> bool operator()(Handler &h)
+	{
+		// Number of values in each open object or array.
+		TArray<unsigned> counts;
+		counts.Push(0);
+
+		while (p < end)
+		{
+			uint8_t tag = *p++;
+			const char *str;
+			unsigned len;
+			uint64_t u;
+			int64_t i;
+
+			switch (tag)
+			{
+			case BIN_Null:
+				h.Null();
+				break;
+
+			case BIN_False:
+			case BIN_True:
+				h.Bool(tag == BIN_True);
+				break;
+
+			case BIN_Int:
+				if (!GetSigned(i)) return false;
+				h.Int((int)i);
+				break;
+
+			case BIN_Int64:
+				if (!GetSigned(i)) return false;
+				h.Int64(i);
+				break;
+
+			case BIN_Uint:
+				if (!GetVarint(u)) return false;
+				h.Uint((unsigned)u);
+				break;
+
+			case BIN_Uint64:
+				if (!GetVarint(u)) return false;
+				h.Uint64(u);
+				break;
+
+			case BIN_Double:
+			{
+				if (end - p < 8) return false;
+				uint64_t bits = 0;
+				for (int j = 0; j < 8; j++) bits |= uint64_t(*p++) << (j * 8);
+				double d;
+				memcpy(&d, &bits, sizeof(d));
+				h.Double(d);
+				break;
+			}
+
+			case BIN_String:
+				if (!GetBytes(str, len)) return false;
+				h.String(str, len, true);
+				break;
+
+			case BIN_StartObject:
+				h.StartObject();
+				counts.Last()++;
+				counts.Push(0);
+				continue;
+
+			case BIN_StartArray:
+				h.StartArray();
+				counts.Last()++;
+				counts.Push(0);
+				continue;
+
+			case BIN_EndObject:
+				if (counts.Size() < 2) return false;
+				h.EndObject(counts.Last());
+				counts.Pop();
+				continue;
+
+			case BIN_EndArray:
+				if (counts.Size() < 2) return false;
+				h.EndArray(counts.Last());
+				counts.Pop();
+				continue;
+
+			case BIN_NewKey:
+				if (!GetBytes(str, len)) return false;
+				keys.Push(std::make_pair(str, len));
+				h.Key(str, len, true);
+				continue;
+
+			case BIN_Key:
+				if (!GetVarint(u) || u >= keys.Size()) return false;
+				h.Key(keys[(unsigned)u].first, keys[(unsigned)u].second, true);
+				continue;
+
+			default:
+				return false;
+			}
+			counts.Last()++;
+		}
+		return counts.Size() == 1 && counts[0] == 1;
+	}
+};
+
+bool ReadBinarySerializerData(rapidjson::Document &doc, const char *buffer, size_t length)
+{
+	if (length < sizeof(BinarySerializerMagic) || memcmp(buffer, BinarySerializerMagic, sizeof(BinarySerializerMagic)))
+	{
+		return false;
+	}
+	FBinarySerializerReader reader((const uint8_t *)buffer + sizeof(BinarySerializerMagic), length - sizeof(BinarySerializerMagic));
+	doc.Populate(reader);
+	return true;
+}
+
 //==========================================================================
 //
 //
 //
 //==========================================================================
 
-bool FSerializer::OpenWriter(bool pretty)
+bool FSerializer::OpenWriter(bool pretty, bool binary)
 {
 	if (w != nullptr || r != nullptr) return false;
 
 	mErrors = 0;
-	w = new FWriter(pretty);
+	w = new FWriter(pretty, binary);
 	BeginObject(nullptr);
 	return true;
 }
@@ -168,7 +335,7 @@ bool FSerializer::OpenReader(FCompressedBuffer *input)
 	else
 	{
 		TArray<char> unpacked(input->mSize);
-		input->Decompress(unpacked.Data());
+		if (!input->Decompress(unpacked.Data())) return false;
 		r = new FReader(unpacked.Data(), input->mSize);
 	}
 	return true;
@@ -774,9 +941,9 @@ const char *FSerializer::GetOutput(unsigned *len)
 	EndObject();
 	if (len != nullptr)
 	{
-		*len = (unsigned)w->mOutString.GetSize();
+		*len = (unsigned)w->GetOutputSize();
 	}
-	return w->mOutString.GetString();
+	return w->GetOutput();
 }
 
 //==========================================================================
@@ -786,21 +953,55 @@ const char *FSerializer::GetOutput(unsigned *len)
 //==========================================================================
 
 FCompressedBuffer FSerializer::GetCompressedOutput()
+{
+	if (isReading()) return{ 0,0,0,0,0,nullptr };
+	WriteObjects();
+	EndObject();
+	return CompressSerializerData(w->GetOutput(), w->GetOutputSize());
+}
+
+//==========================================================================
+//
+// Returns a copy of the uncompressed output so that compression can be
+// done later with CompressSerializerData, e.g. on another thread.
+//
+//==========================================================================
+
+FCompressedBuffer FSerializer::GetStoredOutput()
 {
 	if (isReading()) return{ 0,0,0,0,0,nullptr };
 	FCompressedBuffer buff;
 	WriteObjects();
 	EndObject();
 	buff.filename = nullptr;
-	buff.mSize = (unsigned)w->mOutString.GetSize();
-	buff.mCRC32 = crc32(0, (const Bytef*)w->mOutString.GetString(), buff.mSize);
+	buff.mSize = buff.mCompressedSize = (unsigned)w->GetOutputSize();
+	buff.mCRC32 = 0;
+	buff.mMethod = METHOD_STORED;
+	buff.mBuffer = new char[buff.mSize + 1];
+	memcpy(buff.mBuffer, w->GetOutput(), buff.mSize);
+	buff.mBuffer[buff.mSize] = 0;
+	return buff;
+}
+
+//==========================================================================
+//
+// This does not use any global state so it may be called from any thread.
+//
+//==========================================================================
+
+FCompressedBuffer CompressSerializerData(const char *data, size_t size)
+{
+	FCompressedBuffer buff;
+	buff.filename = nullptr;
+	buff.mSize = (unsigned)size;
+	buff.mCRC32 = crc32(0, (const Bytef*)data, buff.mSize);
 
 	uint8_t *compressbuf = new uint8_t[buff.mSize+1];
 
 	z_stream stream;
 	int err;
 
-	stream.next_in = (Bytef *)w->mOutString.GetString();
+	stream.next_in = (Bytef *)data;
 	stream.avail_in = (unsigned)buff.mSize;
 	stream.next_out = (Bytef*)compressbuf;
 	stream.avail_out = (unsigned)buff.mSize;
@@ -834,12 +1035,162 @@ FCompressedBuffer FSerializer::GetCompressedOutput()
 	}
 
 error:
-	memcpy(compressbuf, w->mOutString.GetString(), buff.mSize + 1);
+	memcpy(compressbuf, data, buff.mSize);
+	compressbuf[buff.mSize] = 0;
+	buff.mBuffer = (char*)compressbuf;
 	buff.mCompressedSize = buff.mSize;
 	buff.mMethod = METHOD_STORED;
 	return buff;
 }
 
+//==========================================================================
+//
+// Serializer deltas
+//
+// A delta describes one serializer output in terms of another one, as a
+// list of literal runs and copies from the base. The base is indexed in
+// fixed size blocks and the new data is scanned with a rolling hash, so
+// content that merely moved (e.g. because an object was inserted before
+// it) is still found. This works for JSON and binary output alike.
+//
+//==========================================================================
+
+enum
+{
+	DELTA_BLOCK = 32,
+	DELTA_HASHMUL = 0x01000193,
+};
+
+static void PutDeltaVarint(TArray<uint8_t> &out, size_t v)
+{
+	while (v >= 0x80)
+	{
+		out.Push(uint8_t(v | 0x80));
+		v >>= 7;
+	}
+	out.Push(uint8_t(v));
+}
+
+static bool GetDeltaVarint(const uint8_t *&p, const uint8_t *end, size_t &v)
+{
+	v = 0;
+	for (int shift = 0; p < end && shift < 64; shift += 7)
+	{
+		uint8_t b = *p++;
+		v |= size_t(b & 0x7f) << shift;
+		if (!(b & 0x80)) return true;
+	}
+	return false;
+}
+
+static uint32_t DeltaBlockHash(const uint8_t *p)
+{
+	uint32_t h = 0;
+	for (int i = 0; i < DELTA_BLOCK; i++) h = h * DELTA_HASHMUL + p[i];
+	return h;
+}
+
+static void PutDeltaLiteral(TArray<uint8_t> &out, const uint8_t *data, size_t start, size_t end)
+{
+	if (end > start)
+	{
+		PutDeltaVarint(out, (end - start) << 1);
+		memcpy(&out[out.Reserve(unsigned(end - start))], data + start, end - start);
+	}
+}
+
+TArray<uint8_t> EncodeSerializerDelta(const char *basebuf, size_t basesize, const char *databuf, size_t datasize)
+{
+	auto base = (const uint8_t *)basebuf;
+	auto data = (const uint8_t *)databuf;
+	TArray<uint8_t> out;
+
+	PutDeltaVarint(out, basesize);
+	PutDeltaVarint(out, crc32(0, base, (unsigned)basesize));
+	PutDeltaVarint(out, datasize);
+
+	size_t numblocks = basesize / DELTA_BLOCK;
+	unsigned hashsize = 1024;
+	while (hashsize < numblocks * 2) hashsize <<= 1;
+	TArray<int> hash(hashsize, true);
+	for (auto &h : hash) h = -1;
+	for (size_t i = 0; i < numblocks; i++)
+	{
+		hash[DeltaBlockHash(base + i * DELTA_BLOCK) & (hashsize - 1)] = int(i * DELTA_BLOCK);
+	}
+
+	// Multiplier for removing the byte that leaves the window.
+	uint32_t outmul = 1;
+	for (int i = 0; i < DELTA_BLOCK - 1; i++) outmul *= DELTA_HASHMUL;
+
+	size_t pos = 0, litstart = 0;
+	uint32_t h = datasize >= DELTA_BLOCK ? DeltaBlockHash(data) : 0;
+	while (numblocks > 0 && pos + DELTA_BLOCK <= datasize)
+	{
+		int match = hash[h & (hashsize - 1)];
+		if (match >= 0 && !memcmp(base + match, data + pos, DELTA_BLOCK))
+		{
+			size_t from = match, start = pos, len = DELTA_BLOCK;
+			while (start > litstart && from > 0 && base[from - 1] == data[start - 1])
+			{
+				from--, start--, len++;
+			}
+			while (start + len < datasize && from + len < basesize && base[from + len] == data[start + len])
+			{
+				len++;
+			}
+			PutDeltaLiteral(out, data, litstart, start);
+			PutDeltaVarint(out, (len << 1) | 1);
+			PutDeltaVarint(out, from);
+			pos = litstart = start + len;
+			if (pos + DELTA_BLOCK <= datasize) h = DeltaBlockHash(data + pos);
+		}
+		else
+		{
+			if (pos + DELTA_BLOCK < datasize)
+			{
+				h = (h - data[pos] * outmul) * DELTA_HASHMUL + data[pos + DELTA_BLOCK];
+			}
+			pos++;
+		}
+	}
+	PutDeltaLiteral(out, data, litstart, datasize);
+	return out;
+}
+
+bool DecodeSerializerDelta(const char *basebuf, size_t basesize, const uint8_t *delta, size_t deltasize, TArray<char> &output)
+{
+	const uint8_t *p = delta, *end = delta + deltasize;
+	size_t checksize, checkcrc, datasize;
+
+	if (!GetDeltaVarint(p, end, checksize) || !GetDeltaVarint(p, end, checkcrc) || !GetDeltaVarint(p, end, datasize))
+		return false;
+	if (checksize != basesize || checkcrc != crc32(0, (const uint8_t *)basebuf, (unsigned)basesize))
+		return false;
+
+	output.Resize(unsigned(datasize));
+	size_t pos = 0, op, from;
+	while (p < end)
+	{
+		if (!GetDeltaVarint(p, end, op)) return false;
+		size_t len = op >> 1;
+		if (len > datasize - pos) return false;
+		if (op & 1)
+		{
+			if (!GetDeltaVarint(p, end, from) || from > basesize || len > basesize - from) return false;
+			memcpy(&output[pos], basebuf + from, len);
+		}
+		else
+		{
+			if (len > size_t(end - p)) return false;
+			memcpy(&output[pos], p, len);
+			p += len;
+		}
+		pos += len;
+	}
+	return pos == datasize;
+}
+
 //==========================================================================
 //
 //
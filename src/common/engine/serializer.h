@@ -85,7 +85,7 @@ public:
 		Close();
 	}
 	void SetUniqueSoundNames() { soundNamesAreUnique = true; }
-	bool OpenWriter(bool pretty = true);
+	bool OpenWriter(bool pretty = true, bool binary = false);
 	bool OpenReader(const char *buffer, size_t length);
 	bool OpenReader(FileSys::FCompressedBuffer *input);
 	void Close();
@@ -101,6 +101,7 @@ public:
 	const char *GetKey();
 	const char *GetOutput(unsigned *len = nullptr);
 	FileSys::FCompressedBuffer GetCompressedOutput();
+	FileSys::FCompressedBuffer GetStoredOutput();
 	// The sprite serializer is a special case because it is needed by the VM to handle its 'spriteid' type.
 	virtual FSerializer &Sprite(const char *key, int32_t &spritenum, int32_t *def);
 	// This is only needed by the type system.
@@ -426,6 +427,9 @@ inline SaveRecord::SaveRecord(const char* nm, void (*handler)(FSerializer& arc))
 	saveRecords.records.Push(this);
 }
 
+FileSys::FCompressedBuffer CompressSerializerData(const char *data, size_t size);
+TArray<uint8_t> EncodeSerializerDelta(const char *base, size_t basesize, const char *data, size_t datasize);
+bool DecodeSerializerDelta(const char *base, size_t basesize, const uint8_t *delta, size_t deltasize, TArray<char> &output);
 FString DictionaryToString(const Dictionary &dict);
 Dictionary *DictionaryFromString(const FString &string);
 
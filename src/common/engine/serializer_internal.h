@@ -25,6 +25,42 @@ struct FJSONObject
 	}
 };
 
+//==========================================================================
+//
+// Binary savegame format
+//
+// Instead of JSON text the writer can output a compact binary stream that
+// records the same sequence of writer calls. Keys are only stored in full
+// the first time they appear and are referenced by index afterward.
+// Reading it back populates the same rapidjson document that parsing the
+// text would have produced, so the reading side is shared.
+//
+//==========================================================================
+
+enum EBinarySerializerTag : uint8_t
+{
+	BIN_Null,
+	BIN_False,
+	BIN_True,
+	BIN_Int,
+	BIN_Int64,
+	BIN_Uint,
+	BIN_Uint64,
+	BIN_Double,
+	BIN_String,
+	BIN_StartObject,
+	BIN_EndObject,
+	BIN_StartArray,
+	BIN_EndArray,
+	BIN_NewKey,		// key string that has not been used before
+	BIN_Key,		// index of a key that was already written
+};
+
+// JSON text cannot start with this.
+static const char BinarySerializerMagic[8] = { '\x1a', 'G', 'Z', 'B', 'I', 'N', '1', 0 };
+
+bool ReadBinarySerializerData(rapidjson::Document &doc, const char *buffer, size_t length);
+
 //==========================================================================
 //
 // some wrapper stuff to keep the RapidJSON dependencies out of the global headers.
@@ -44,9 +80,35 @@ struct FWriter
 	TArray<DObject *> mDObjects;
 	TMap<DObject *, int> mObjectMap;
 
-	FWriter(bool pretty)
+	// binary output
+	struct BinaryKey
 	{
-		if (!pretty)
+		unsigned Offset;
+		unsigned Length;
+		int Next;
+	};
+	enum { BINARY_KEY_BUCKETS = 4096 };
+
+	bool mBinary;
+	TArray<uint8_t> mBinaryOut;
+	TArray<int> mKeyBuckets;
+	TArray<BinaryKey> mKeys;
+	TArray<char> mKeyText;
+
+	FWriter(bool pretty, bool binary = false)
+	{
+		mBinary = binary;
+		if (binary)
+		{
+			mWriter1 = nullptr;
+			mWriter2 = nullptr;
+			mBinaryOut.Grow(65536);
+			mBinaryOut.Resize(sizeof(BinarySerializerMagic));
+			memcpy(mBinaryOut.Data(), BinarySerializerMagic, sizeof(BinarySerializerMagic));
+			mKeyBuckets.Resize(BINARY_KEY_BUCKETS);
+			for (auto &b : mKeyBuckets) b = -1;
+		}
+		else if (!pretty)
 		{
 			mWriter1 = new Writer(mOutString);
 			mWriter2 = nullptr;
@@ -70,40 +132,113 @@ struct FWriter
 		return mInObject.Size() > 0 && mInObject.Last();
 	}
 
+	const char *GetOutput() const
+	{
+		return mBinary ? (const char *)mBinaryOut.Data() : mOutString.GetString();
+	}
+
+	size_t GetOutputSize() const
+	{
+		return mBinary ? mBinaryOut.Size() : mOutString.GetSize();
+	}
+
+	void PutTag(uint8_t tag)
+	{
+		mBinaryOut.Push(tag);
+	}
+
+	void PutVarint(uint64_t v)
+	{
+		while (v >= 0x80)
+		{
+			mBinaryOut.Push(uint8_t(v | 0x80));
+			v >>= 7;
+		}
+		mBinaryOut.Push(uint8_t(v));
+	}
+
+	void PutSigned(int64_t v)
+	{
+		PutVarint((uint64_t(v) << 1) ^ uint64_t(v >> 63));
+	}
+
+	void PutBytes(uint8_t tag, const char *str, size_t len)
+	{
+		PutTag(tag);
+		PutVarint(len);
+		if (len > 0)
+		{
+			unsigned pos = mBinaryOut.Reserve((unsigned)len);
+			memcpy(&mBinaryOut[pos], str, len);
+		}
+	}
+
+	void PutKey(const char *k)
+	{
+		size_t len = strlen(k);
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < len; i++) hash = (hash ^ uint8_t(k[i])) * 16777619u;
+
+		int &bucket = mKeyBuckets[hash % BINARY_KEY_BUCKETS];
+		for (int i = bucket; i >= 0; i = mKeys[i].Next)
+		{
+			if (mKeys[i].Length == len && !memcmp(&mKeyText[mKeys[i].Offset], k, len))
+			{
+				PutTag(BIN_Key);
+				PutVarint(i);
+				return;
+			}
+		}
+		mKeys.Push({ mKeyText.Size(), (unsigned)len, bucket });
+		bucket = mKeys.Size() - 1;
+		if (len > 0)
+		{
+			unsigned pos = mKeyText.Reserve((unsigned)len);
+			memcpy(&mKeyText[pos], k, len);
+		}
+		PutBytes(BIN_NewKey, k, len);
+	}
+
 	void StartObject()
 	{
 		if (mWriter1) mWriter1->StartObject();
 		else if (mWriter2) mWriter2->StartObject();
+		else PutTag(BIN_StartObject);
 	}
 
 	void EndObject()
 	{
 		if (mWriter1) mWriter1->EndObject();
 		else if (mWriter2) mWriter2->EndObject();
+		else PutTag(BIN_EndObject);
 	}
 
 	void StartArray()
 	{
 		if (mWriter1) mWriter1->StartArray();
 		else if (mWriter2) mWriter2->StartArray();
+		else PutTag(BIN_StartArray);
 	}
 
 	void EndArray()
 	{
 		if (mWriter1) mWriter1->EndArray();
 		else if (mWriter2) mWriter2->EndArray();
+		else PutTag(BIN_EndArray);
 	}
 
 	void Key(const char *k)
 	{
 		if (mWriter1) mWriter1->Key(k);
 		else if (mWriter2) mWriter2->Key(k);
+		else PutKey(k);
 	}
 
 	void Null()
 	{
 		if (mWriter1) mWriter1->Null();
 		else if (mWriter2) mWriter2->Null();
+		else PutTag(BIN_Null);
 	}
 
 	void StringU(const char *k, bool encode)
@@ -111,6 +246,7 @@ struct FWriter
 		if (encode) k = StringToUnicode(k);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else PutBytes(BIN_String, k, strlen(k));
 	}
 
 	void String(const char *k)
@@ -118,6 +254,7 @@ struct FWriter
 		k = StringToUnicode(k);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else PutBytes(BIN_String, k, strlen(k));
 	}
 
 	void String(const char *k, int size)
@@ -125,36 +262,58 @@ struct FWriter
 		k = StringToUnicode(k, size);
 		if (mWriter1) mWriter1->String(k);
 		else if (mWriter2) mWriter2->String(k);
+		else PutBytes(BIN_String, k, strlen(k));
 	}
 
 	void Bool(bool k)
 	{
 		if (mWriter1) mWriter1->Bool(k);
 		else if (mWriter2) mWriter2->Bool(k);
+		else PutTag(k ? BIN_True : BIN_False);
 	}
 
 	void Int(int32_t k)
 	{
 		if (mWriter1) mWriter1->Int(k);
 		else if (mWriter2) mWriter2->Int(k);
+		else
+		{
+			PutTag(BIN_Int);
+			PutSigned(k);
+		}
 	}
 
 	void Int64(int64_t k)
 	{
 		if (mWriter1) mWriter1->Int64(k);
 		else if (mWriter2) mWriter2->Int64(k);
+		else
+		{
+			PutTag(BIN_Int64);
+			PutSigned(k);
+		}
 	}
 
 	void Uint(uint32_t k)
 	{
 		if (mWriter1) mWriter1->Uint(k);
 		else if (mWriter2) mWriter2->Uint(k);
+		else
+		{
+			PutTag(BIN_Uint);
+			PutVarint(k);
+		}
 	}
 
 	void Uint64(int64_t k)
 	{
 		if (mWriter1) mWriter1->Uint64(k);
 		else if (mWriter2) mWriter2->Uint64(k);
+		else
+		{
+			PutTag(BIN_Uint64);
+			PutVarint(k);
+		}
 	}
 
 	void Double(double k)
@@ -167,6 +326,13 @@ struct FWriter
 		{
 			mWriter2->Double(k);
 		}
+		else
+		{
+			uint64_t bits;
+			memcpy(&bits, &k, sizeof(bits));
+			PutTag(BIN_Double);
+			for (int i = 0; i < 8; i++, bits >>= 8) mBinaryOut.Push(uint8_t(bits));
+		}
 	}
 
 };
@@ -187,7 +353,10 @@ struct FReader
 
 	FReader(const char *buffer, size_t length)
 	{
-		mDoc.Parse(buffer, length);
+		if (!ReadBinarySerializerData(mDoc, buffer, length))
+		{
+			mDoc.Parse(buffer, length);
+		}
 		mObjects.Push(FJSONObject(&mDoc));
 	}
 
@@ -46,6 +46,7 @@ class cycle_t
 {
 public:
 	cycle_t &operator= (const cycle_t &o) { return *this; }
+	cycle_t &operator+= (const cycle_t &o) { return *this; }
 	void Reset() {}
 	void Clock() {}
 	void ResetAndClock() {}
@@ -153,6 +154,12 @@ public:
 		return Sec * 1e3;
 	}
 
+	cycle_t &operator+= (const cycle_t &o)
+	{
+		Sec += o.Sec;
+		return *this;
+	}
+
 private:
 	double Sec;
 };
@@ -260,6 +267,12 @@ public:
 		return Counter;
 	}
 
+	cycle_t &operator+= (const cycle_t &o)
+	{
+		Counter += o.Counter;
+		return *this;
+	}
+
 private:
 	int64_t Counter;
 };
@@ -0,0 +1,254 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright 2024 GZDoom Maintainers and Contributors
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//		Hierarchical zone profiler with per-thread ring buffers and
+//		Chrome trace output.
+//
+//-----------------------------------------------------------------------------
+
+#include <mutex>
+#include <algorithm>
+#include "zoneprofiler.h"
+#include "tarray.h"
+#include "zstring.h"
+#include "i_time.h"
+#include "c_dispatch.h"
+#include "printf.h"
+#include "files.h"
+#include "stats.h"
+
+bool ProfileZonesActive;
+
+// 4 MB per thread that has ever entered a zone while profiling was on.
+enum { ZONE_BUFFER_SIZE = 1 << 17 };
+
+struct FProfileZoneThread
+{
+	std::mutex Lock;	// held while an event gets written, so that dumps never see a half written one.
+	TArray<FProfileZoneEvent> Events;
+	unsigned Next = 0;
+	bool Wrapped = false;
+	int Depth = 0;
+	int Index = 0;
+	uint64_t Total = 0;		// events ever written
+	uint64_t StatTotal = 0;	// events already shown by the 'zones' stat
+};
+
+static std::mutex ZoneThreadLock;
+static TDeletingArray<FProfileZoneThread *> ZoneThreads;
+static thread_local FProfileZoneThread *ZoneThread;
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+uint64_t ProfileZone_Begin()
+{
+	if (ZoneThread == nullptr)
+	{
+		std::lock_guard<std::mutex> lock(ZoneThreadLock);
+		ZoneThread = new FProfileZoneThread;
+		ZoneThread->Events.Resize(ZONE_BUFFER_SIZE);
+		ZoneThread->Index = ZoneThreads.Size();
+		ZoneThreads.Push(ZoneThread);
+	}
+	ZoneThread->Depth++;
+	return I_nsTime();
+}
+
+void ProfileZone_End(const char *name, uint64_t start)
+{
+	uint64_t end = I_nsTime();
+	auto thread = ZoneThread;
+
+	thread->Depth--;
+	std::lock_guard<std::mutex> lock(thread->Lock);
+	thread->Events[thread->Next] = { name, start, end, thread->Depth };
+	thread->Total++;
+	if (++thread->Next == ZONE_BUFFER_SIZE)
+	{
+		thread->Next = 0;
+		thread->Wrapped = true;
+	}
+}
+
+//==========================================================================
+//
+// Writes everything still in the ring buffers as Chrome trace events.
+// Each thread's buffer is locked while it is read, so zones that are still
+// open at that point are simply not part of the trace.
+//
+//==========================================================================
+
+static void WriteJsonString(FileWriter *fw, const char *str)
+{
+	fw->Write("\"", 1);
+	for (; *str != 0; str++)
+	{
+		if (*str == '"' || *str == '\\') fw->Write("\\", 1);
+		fw->Write(str, 1);
+	}
+	fw->Write("\"", 1);
+}
+
+bool ProfileZone_WriteTrace(const char *filename)
+{
+	std::lock_guard<std::mutex> lock(ZoneThreadLock);
+
+	uint64_t base = UINT64_MAX;
+	for (auto thread : ZoneThreads)
+	{
+		std::lock_guard<std::mutex> threadlock(thread->Lock);
+		unsigned count = thread->Wrapped ? ZONE_BUFFER_SIZE : thread->Next;
+		for (unsigned i = 0; i < count; i++) base = min(base, thread->Events[i].Start);
+	}
+
+	FileWriter *fw = FileWriter::Open(filename);
+	if (fw == nullptr) return false;
+
+	fw->Printf("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+	bool first = true;
+	for (auto thread : ZoneThreads)
+	{
+		fw->Printf("%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%d,\"args\":{\"name\":\"Thread %d\"}}", first ? "" : ",\n", thread->Index, thread->Index);
+		first = false;
+
+		// Oldest events first, so that a wrapped buffer still reads in order.
+		std::lock_guard<std::mutex> threadlock(thread->Lock);
+		unsigned count = thread->Wrapped ? ZONE_BUFFER_SIZE : thread->Next;
+		unsigned pos = thread->Wrapped ? thread->Next : 0;
+		for (unsigned i = 0; i < count; i++, pos = (pos + 1) % ZONE_BUFFER_SIZE)
+		{
+			auto &ev = thread->Events[pos];
+			fw->Printf(",\n{\"name\":");
+			WriteJsonString(fw, ev.Name);
+			fw->Printf(",\"ph\":\"X\",\"pid\":0,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"depth\":%d}}",
+				thread->Index, (ev.Start - base) / 1000., (ev.End - ev.Start) / 1000., ev.Depth);
+		}
+	}
+	fw->Printf("\n]}\n");
+	delete fw;
+	return true;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static void ClearZoneBuffers()
+{
+	std::lock_guard<std::mutex> lock(ZoneThreadLock);
+	for (auto thread : ZoneThreads)
+	{
+		std::lock_guard<std::mutex> threadlock(thread->Lock);
+		thread->Next = 0;
+		thread->Wrapped = false;
+		thread->StatTotal = thread->Total;
+	}
+}
+
+//==========================================================================
+//
+// Sums up the zones completed since the stat was last drawn, per name.
+//
+//==========================================================================
+
+ADD_STAT(zones)
+{
+	if (!ProfileZonesActive) return "Zone profiling is off, use 'profilezones start'";
+
+	struct FZoneSum
+	{
+		const char *Name;
+		uint64_t Time;
+		int Count;
+	};
+	TArray<FZoneSum> sums;
+
+	std::lock_guard<std::mutex> lock(ZoneThreadLock);
+	for (auto thread : ZoneThreads)
+	{
+		std::lock_guard<std::mutex> threadlock(thread->Lock);
+		unsigned count = (unsigned)min<uint64_t>(thread->Total - thread->StatTotal, ZONE_BUFFER_SIZE);
+		unsigned pos = (thread->Next + ZONE_BUFFER_SIZE - count) % ZONE_BUFFER_SIZE;
+		thread->StatTotal = thread->Total;
+		for (unsigned i = 0; i < count; i++, pos = (pos + 1) % ZONE_BUFFER_SIZE)
+		{
+			auto &ev = thread->Events[pos];
+			unsigned j;
+			for (j = 0; j < sums.Size(); j++)
+			{
+				if (sums[j].Name == ev.Name || !strcmp(sums[j].Name, ev.Name)) break;
+			}
+			if (j == sums.Size()) sums.Push({ ev.Name, 0, 0 });
+			sums[j].Time += ev.End - ev.Start;
+			sums[j].Count++;
+		}
+	}
+
+	std::sort(sums.begin(), sums.end(), [](const FZoneSum &a, const FZoneSum &b) { return a.Time > b.Time; });
+	FString out;
+	for (unsigned i = 0; i < sums.Size() && i < 20; i++)
+	{
+		if (i > 0) out << '\n';
+		out.AppendFormat("%-24s %8.3f ms  %6d", sums[i].Name, sums[i].Time / 1'000'000., sums[i].Count);
+	}
+	return out;
+}
+
+CCMD(profilezones)
+{
+	if (argv.argc() >= 2 && !stricmp(argv[1], "start"))
+	{
+		ClearZoneBuffers();
+		ProfileZonesActive = true;
+		Printf("Zone profiling started\n");
+	}
+	else if (argv.argc() >= 2 && !stricmp(argv[1], "stop"))
+	{
+		ProfileZonesActive = false;
+		Printf("Zone profiling stopped\n");
+	}
+	else if (argv.argc() >= 2 && !stricmp(argv[1], "dump"))
+	{
+		const char *filename = argv.argc() >= 3 ? argv[2] : "zoneprofile.json";
+		if (ProfileZone_WriteTrace(filename))
+		{
+			Printf("Zone profile written to %s\n", filename);
+		}
+		else
+		{
+			Printf(PRINT_HIGH, "Unable to write zone profile to %s\n", filename);
+		}
+	}
+	else
+	{
+		Printf(
+			"Usage: profilezones start\n"
+			"       profilezones stop\n"
+			"       profilezones dump [filename]\n\n"
+			"Writes a Chrome trace that can be opened in chrome://tracing or ui.perfetto.dev.\n"
+			"'stat zones' shows the time spent per zone while profiling.\n");
+	}
+}
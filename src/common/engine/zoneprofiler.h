@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+
+//==========================================================================
+//
+// Hierarchical zone profiler
+//
+// Zones are scoped timers that may nest. Every thread records the zones
+// it completes into its own ring buffer, which can be written out as a
+// Chrome trace (chrome://tracing, ui.perfetto.dev) with 'profilezones dump'
+// or summed up per frame with 'stat zones'.
+// While profiling is off a zone costs a single branch.
+//
+//==========================================================================
+
+extern bool ProfileZonesActive;
+
+struct FProfileZoneEvent
+{
+	const char *Name;	// must stay valid until the trace has been dumped
+	uint64_t Start;
+	uint64_t End;
+	int Depth;
+};
+
+uint64_t ProfileZone_Begin();
+void ProfileZone_End(const char *name, uint64_t start);
+
+class FProfileZone
+{
+	const char *name;
+	uint64_t start;
+
+public:
+	explicit FProfileZone(const char *zonename)
+	{
+		if (ProfileZonesActive)
+		{
+			name = zonename;
+			start = ProfileZone_Begin();
+		}
+		else name = nullptr;
+	}
+
+	~FProfileZone()
+	{
+		if (name != nullptr) ProfileZone_End(name, start);
+	}
+
+	FProfileZone(const FProfileZone &) = delete;
+	FProfileZone &operator=(const FProfileZone &) = delete;
+};
+
+bool ProfileZone_WriteTrace(const char *filename);
@@ -74,6 +74,8 @@ public:
 class FileReader;
 
 // an opaque memory buffer to the file's content. Can either own the memory or just point to an external buffer.
+// For uncompressed lumps of memory mapped files the external buffer is the mapping itself, so a non-owning
+// FileData must not outlive the resource file it came from.
 class FileData
 {
 	void* memory;
@@ -247,6 +249,7 @@ public:
 	}
 
 	bool OpenFile(const char *filename, Size start = 0, Size length = -1, bool buffered = false);
+	bool OpenFileMapped(const char *filename);	// maps the whole file into memory if possible, otherwise same as OpenFile.
 	bool OpenFilePart(FileReader &parent, Size start, Size length);
 	bool OpenMemory(const void *mem, Size length);	// read directly from the buffer
 	bool OpenMemoryArray(FileData& data);	// take the given array
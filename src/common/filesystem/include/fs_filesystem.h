@@ -149,6 +149,7 @@ public:
 protected:
 
 	struct LumpRecord;
+	struct PendingFile;
 
 	std::vector<FResourceFile *> Files;
 	std::vector<LumpRecord> FileInfo;
@@ -177,6 +178,8 @@ protected:
 private:
 	void DeleteAll();
 	void MoveLumpsInFolder(const char *);
+	FResourceFile* OpenFile(const char* filename, FileReader* filer, LumpFilterInfo* filter, FileSystemMessageFunc Printf);
+	void AddResourceFile(const char* filename, FResourceFile* resfile, LumpFilterInfo* filter, FileSystemMessageFunc Printf);
 
 };
 
@@ -27,6 +27,8 @@ struct LumpFilterInfo
 	std::vector<std::string> blockednames;			// File names that will never be accepted (e.g. dehacked.exe for Doom)
 	std::function<bool(const char*, const char*)> filenamecheck;	// for scanning directories, this allows to eliminate unwanted content.
 	std::function<void()> postprocessFunc;
+	std::string indexCachePath;	// if set, the parsed directories of zips and 7zs get cached in this folder.
+	bool mapFiles = false;		// if set, files are memory mapped instead of read through stdio. They cannot be modified while the file system is open.
 };
 
 enum class FSMessageLevel
@@ -108,6 +110,7 @@ struct FResourceEntry
 };
 
 void SetMainThread();
+struct FArchiveIndexHeader;
 
 class FResourceFile
 {
@@ -133,6 +136,8 @@ protected:
 	}
 	bool IsFileInFolder(const char* const resPath);
 	void CheckEmbedded(uint32_t entry, LumpFilterInfo* lfi);
+	bool LoadIndex(LumpFilterInfo* filter, uint64_t dirpos, uint64_t dirsize);
+	void SaveIndex(LumpFilterInfo* filter, uint64_t dirpos, uint64_t dirsize);
 
 private:
 	uint32_t FirstLump;
@@ -141,6 +146,7 @@ private:
 	bool FindPrefixRange(const char* filter, uint32_t max, uint32_t &start, uint32_t &end);
 	void JunkLeftoverFilters(uint32_t max);
 	void FindCommonFolder(LumpFilterInfo* filter);
+	bool GetIndexStamp(LumpFilterInfo* filter, uint64_t dirpos, uint64_t dirsize, std::string& cachefile, FArchiveIndexHeader& header);
 	static FResourceFile *DoOpenResourceFile(const char *filename, FileReader &file, bool containeronly, LumpFilterInfo* filter, FileSystemMessageFunc Printf, StringPool* sp);
 
 public:
@@ -117,10 +117,9 @@ struct C7zArchive
 
 	C7zArchive(FileReader &file) : ArchiveStream(file)
 	{
-		if (g_CrcTable[1] == 0)
-		{
-			CrcGenerateTable();
-		}
+		// archives may be opened on several threads at once.
+		static std::once_flag crcinit;
+		std::call_once(crcinit, []() { if (g_CrcTable[1] == 0) CrcGenerateTable(); });
 		file.Seek(0, FileReader::SeekSet);
 		LookToRead2_CreateVTable(&LookStream, false);
 		LookStream.realStream = &ArchiveStream.s;
@@ -175,6 +174,8 @@ class F7ZFile : public FResourceFile
 	C7zArchive *Archive;
 	FCriticalSection critsec;
 
+	bool OpenArchive(FileSystemMessageFunc Printf);
+
 public:
 	F7ZFile(const char * filename, FileReader &filer, StringPool* sp);
 	bool Open(LumpFilterInfo* filter, FileSystemMessageFunc Printf);
@@ -204,10 +205,9 @@ F7ZFile::F7ZFile(const char * filename, FileReader &filer, StringPool* sp)
 //
 //==========================================================================
 
-bool F7ZFile::Open(LumpFilterInfo *filter, FileSystemMessageFunc Printf)
+bool F7ZFile::OpenArchive(FileSystemMessageFunc Printf)
 {
 	Archive = new C7zArchive(Reader);
-	int skipped = 0;
 	SRes res;
 
 	res = Archive->Open();
@@ -215,6 +215,7 @@ bool F7ZFile::Open(LumpFilterInfo *filter, FileSystemMessageFunc Printf)
 	{
 		delete Archive;
 		Archive = NULL;
+		if (Printf == nullptr) return false;	// opened on first access, nothing to report to.
 		if (res == SZ_ERROR_UNSUPPORTED)
 		{
 			Printf(FSMessageLevel::Error, "%s: Decoder does not support this archive\n", FileName);
@@ -233,6 +234,31 @@ bool F7ZFile::Open(LumpFilterInfo *filter, FileSystemMessageFunc Printf)
 		}
 		return false;
 	}
+	return true;
+}
+
+bool F7ZFile::Open(LumpFilterInfo *filter, FileSystemMessageFunc Printf)
+{
+	// The signature header says where the header database is. The cached index is keyed on the database,
+	// so with a cached index the archive's header only gets decoded once something is read from it.
+	static const uint8_t signature[6] = { '7', 'z', 0xBC, 0xAF, 0x27, 0x1C };
+	uint8_t sighead[12];
+	uint64_t headerpos = 0, headersize = 0;
+	Reader.Seek(0, FileReader::SeekSet);
+	if (Reader.Read(sighead, sizeof(sighead)) == sizeof(sighead) && !memcmp(sighead, signature, sizeof(signature)))
+	{
+		headerpos = Reader.ReadUInt64() + 32;
+		headersize = Reader.ReadUInt64();
+	}
+	Reader.Seek(0, FileReader::SeekSet);
+	if (LoadIndex(filter, headerpos, headersize))
+	{
+		GenerateHash();
+		PostProcessArchive(filter);
+		return true;
+	}
+
+	if (!OpenArchive(Printf)) return false;
 
 	CSzArEx* const archPtr = &Archive->DB;
 
@@ -289,6 +315,7 @@ bool F7ZFile::Open(LumpFilterInfo *filter, FileSystemMessageFunc Printf)
 		}
 	}
 
+	SaveIndex(filter, headerpos, headersize);
 	GenerateHash();
 	PostProcessArchive(filter);
 	return true;
@@ -322,6 +349,11 @@ FileData F7ZFile::Read(uint32_t entry)
 		auto p = buffer.allocate(Entries[entry].Length);
 		// There is no realistic way to keep multiple references to a 7z file open without massive overhead so to make this thread-safe a mutex is the only option.
 		std::lock_guard<FCriticalSection> lock(critsec);
+		if (Archive == nullptr && !OpenArchive(nullptr))
+		{
+			buffer.clear();
+			return buffer;
+		}
 		SRes code = Archive->Extract((UInt32)Entries[entry].Position, (char*)p);
 		if (code != SZ_OK) buffer.clear();
 	}
@@ -41,8 +41,6 @@
 #include "fs_stringpool.h"
 
 namespace FileSys {
-	
-std::string FS_FullPath(const char* directory);
 
 //==========================================================================
 //
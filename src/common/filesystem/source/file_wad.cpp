@@ -34,6 +34,7 @@
 */
 
 #include <ctype.h>
+#include <atomic>
 #include "resourcefile.h"
 #include "fs_filesystem.h"
 #include "fs_swap.h"
@@ -349,7 +350,8 @@ void FWadFile::SetNamespace(const char *startmarker, const char *endmarker, name
 void FWadFile::SkinHack (FileSystemMessageFunc Printf)
 {
 	// this being static is not a problem. The only relevant thing is that each skin gets a different number.
-	static int namespc = ns_firstskin;
+	// Wads may be opened on several threads at once so the counter must be atomic.
+	static std::atomic<int> namespc = ns_firstskin;
 	bool skinned = false;
 	bool hasmap = false;
 	uint32_t i;
@@ -365,12 +367,12 @@ void FWadFile::SkinHack (FileSystemMessageFunc Printf)
 			{
 				skinned = true;
 				uint32_t j;
+				int skinnamespace = namespc++;
 
 				for (j = 0; j < NumLumps; j++)
 				{
-					Entries[j].Namespace = namespc;
+					Entries[j].Namespace = skinnamespace;
 				}
-				namespc++;
 			}
 		}
 		// needless to say, this check is entirely useless these days as map names can be more diverse..
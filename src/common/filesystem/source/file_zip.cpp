@@ -133,6 +133,7 @@ bool FZipFile::Open(LumpFilterInfo* filter, FileSystemMessageFunc Printf)
 	bool zip64 = false;
 	uint32_t centraldir = Zip_FindCentralDir(Reader, &zip64);
 	int skipped = 0;
+	bool rejected = false;
 
 	if (centraldir == 0)
 	{
@@ -179,6 +180,16 @@ bool FZipFile::Open(LumpFilterInfo* filter, FileSystemMessageFunc Printf)
 		dirsize = info.DirectorySize;
 		DirectoryOffset = info.DirectoryOffset;
 	}
+
+	// The cached index is keyed on the central directory and the end records that follow it.
+	uint64_t indexsize = (uint64_t)Reader.GetLength() > DirectoryOffset ? Reader.GetLength() - DirectoryOffset : 0;
+	if (LoadIndex(filter, DirectoryOffset, indexsize))
+	{
+		GenerateHash();
+		PostProcessArchive(filter);
+		return true;
+	}
+
 	// Load the entire central directory. Too bad that this contains variable length entries...
 	void *directory = malloc(dirsize);
 	Reader.Seek(DirectoryOffset, FileReader::SeekSet);
@@ -252,6 +263,7 @@ bool FZipFile::Open(LumpFilterInfo* filter, FileSystemMessageFunc Printf)
 		{
 			Printf(FSMessageLevel::Error, "%s: '%s' uses an unsupported compression algorithm (#%d).\n", FileName, name.c_str(), zip_fh->Method);
 			skipped++;
+			rejected = true;
 			continue;
 		}
 		// Also ignore encrypted entries
@@ -260,6 +272,7 @@ bool FZipFile::Open(LumpFilterInfo* filter, FileSystemMessageFunc Printf)
 		{
 			Printf(FSMessageLevel::Error, "%s: '%s' is encrypted. Encryption is not supported.\n", FileName, name.c_str());
 			skipped++;
+			rejected = true;
 			continue;
 		}
 
@@ -284,6 +297,7 @@ bool FZipFile::Open(LumpFilterInfo* filter, FileSystemMessageFunc Printf)
 						// The file system is limited to 32 bit file sizes;
 						Printf(FSMessageLevel::Warning, "%s: '%s' is too large.\n", FileName, name.c_str());
 						skipped++;
+						rejected = true;
 						continue;
 					}
 					UncompressedSize = (uint32_t)zip_64->UncompressedSize;
@@ -318,6 +332,8 @@ bool FZipFile::Open(LumpFilterInfo* filter, FileSystemMessageFunc Printf)
 	NumLumps -= skipped;
 	free(directory);
 
+	// Only cache directories that load cleanly, so that the messages about rejected entries are not lost.
+	if (!rejected) SaveIndex(filter, DirectoryOffset, indexsize);
 	GenerateHash();
 	PostProcessArchive(filter);
 	return true;
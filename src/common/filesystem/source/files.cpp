@@ -40,6 +40,19 @@
 #include <string.h>
 #include "files_internal.h"
 
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 namespace FileSys {
 	
 #ifdef _WIN32
@@ -171,6 +184,73 @@ private:
 	}
 };
 
+//==========================================================================
+//
+// MappedFileReader
+//
+// reads data from a read-only memory mapping of an entire file. Since it
+// exposes the mapping through GetBuffer, resource files opened with it
+// hand out uncompressed entries without copying them.
+//
+//==========================================================================
+
+class MappedFileReader : public MemoryReader
+{
+public:
+	~MappedFileReader()
+	{
+		if (bufptr != nullptr)
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(bufptr);
+#else
+			munmap((void*)bufptr, Length);
+#endif
+		}
+	}
+
+	bool Open(const char *filename)
+	{
+		// Large archives could exhaust a 32 bit address space.
+		if (sizeof(void*) < 8) return false;
+		void *mem = nullptr;
+		ptrdiff_t size = 0;
+#ifdef _WIN32
+		auto widename = toWide(filename);
+		HANDLE file = CreateFileW(widename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (file == INVALID_HANDLE_VALUE) return false;
+		LARGE_INTEGER filesize;
+		if (GetFileSizeEx(file, &filesize) && filesize.QuadPart > 0)
+		{
+			HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+			if (mapping != nullptr)
+			{
+				mem = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+				size = (ptrdiff_t)filesize.QuadPart;
+				CloseHandle(mapping);	// the view keeps the mapping alive.
+			}
+		}
+		CloseHandle(file);
+#else
+		int fd = open(filename, O_RDONLY);
+		if (fd < 0) return false;
+		struct stat st;
+		if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+		{
+			mem = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (mem == MAP_FAILED) mem = nullptr;
+			size = (ptrdiff_t)st.st_size;
+		}
+		close(fd);	// the mapping stays valid after the descriptor is closed.
+#endif
+		if (mem == nullptr) return false;
+		bufptr = (const char*)mem;
+		Length = size;
+		FilePos = 0;
+		return true;
+	}
+};
+
 //==========================================================================
 //
 // FileReaderRedirect
@@ -380,6 +460,19 @@ bool FileReader::OpenFile(const char *filename, FileReader::Size start, FileRead
 	return true;
 }
 
+bool FileReader::OpenFileMapped(const char *filename)
+{
+	auto reader = new MappedFileReader;
+	if (!reader->Open(filename))
+	{
+		delete reader;
+		return OpenFile(filename);
+	}
+	Close();
+	mReader = reader;
+	return true;
+}
+
 bool FileReader::OpenFilePart(FileReader &parent, FileReader::Size start, FileReader::Size length)
 {
 	auto reader = new FileReaderRedirect(parent, start, length);
@@ -41,6 +41,11 @@
 #include <ctype.h>
 #include <string.h>
 #include <inttypes.h>
+#include <stdarg.h>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <thread>
 
 #include "resourcefile.h"
 #include "fs_filesystem.h"
@@ -89,6 +94,49 @@ static void md5Hash(FileReader& reader, uint8_t* digest)
 }
 
 
+//==========================================================================
+//
+// Messages from files that are opened on a worker thread are collected
+// here and printed by the main thread once the file gets added, so that
+// the output is the same as when loading the files one after another.
+//
+//==========================================================================
+
+struct FileSystem::PendingFile
+{
+	FResourceFile* ResFile = nullptr;
+	std::vector<std::pair<FSMessageLevel, std::string>> Messages;
+	std::exception_ptr Error;
+	double ParseTime = 0;
+};
+
+static thread_local std::vector<std::pair<FSMessageLevel, std::string>>* DeferredMessages;
+
+static int DeferredPrintf(FSMessageLevel msglevel, const char* format, ...)
+{
+	va_list ap;
+	va_start(ap, format);
+	char buffer[1024];
+	int len = vsnprintf(buffer, sizeof(buffer), format, ap);
+	va_end(ap);
+	if (DeferredMessages != nullptr && len >= 0)
+	{
+		if (len < (int)sizeof(buffer))
+		{
+			DeferredMessages->emplace_back(msglevel, buffer);
+		}
+		else
+		{
+			std::string text(len, 0);
+			va_start(ap, format);
+			vsnprintf(&text[0], len + 1, format, ap);
+			va_end(ap);
+			DeferredMessages->emplace_back(msglevel, std::move(text));
+		}
+	}
+	return len;
+}
+
 struct FileSystem::LumpRecord
 {
 	FResourceFile *resfile;
@@ -267,9 +315,63 @@ bool FileSystem::InitMultipleFiles (std::vector<std::string>& filenames, LumpFil
 		}
 	}
 
+	// Reading the directories is independent for each file so it is done on as many threads as are available.
+	// Everything that depends on the load order is done afterward, one file at a time in the order given.
+	auto starttime = std::chrono::steady_clock::now();
+	std::vector<PendingFile> pending(filenames.size());
+	std::atomic<size_t> nextfile(0);
+	auto loader = [&]()
+	{
+		size_t i;
+		while ((i = nextfile++) < filenames.size())
+		{
+			auto& file = pending[i];
+			auto filestart = std::chrono::steady_clock::now();
+			DeferredMessages = &file.Messages;
+			try
+			{
+				file.ResFile = OpenFile(filenames[i].c_str(), nullptr, filter, Printf ? DeferredPrintf : nullptr);
+			}
+			catch (...)
+			{
+				file.Error = std::current_exception();
+			}
+			DeferredMessages = nullptr;
+			file.ParseTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - filestart).count();
+		}
+	};
+
+	unsigned numthreads = std::max(std::thread::hardware_concurrency(), 1u);
+	if (numthreads > filenames.size()) numthreads = (unsigned)filenames.size();
+	std::vector<std::thread> threads;
+	for (unsigned i = 1; i < numthreads; i++)
+	{
+		threads.emplace_back(loader);
+	}
+	loader();
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+	auto mergetime = std::chrono::steady_clock::now();
+
 	for(size_t i=0;i<filenames.size(); i++)
 	{
-		AddFile(filenames[i].c_str(), nullptr, filter, Printf);
+		auto& file = pending[i];
+		if (Printf)
+		{
+			for (auto& msg : file.Messages)
+			{
+				Printf(msg.first, "%s", msg.second.c_str());
+			}
+		}
+		if (file.Error)
+		{
+			// do not leak the files that have not been merged yet.
+			for (size_t j = i + 1; j < pending.size(); j++) delete pending[j].ResFile;
+			std::rethrow_exception(file.Error);
+		}
+		if (file.ResFile != nullptr) AddResourceFile(filenames[i].c_str(), file.ResFile, filter, Printf);
 
 		if (i == (unsigned)MaxIwadIndex) MoveLumpsInFolder("after_iwad/");
 		std::string path = "filter/%s";
@@ -285,7 +387,20 @@ bool FileSystem::InitMultipleFiles (std::vector<std::string>& filenames, LumpFil
 	if (filter && filter->postprocessFunc) filter->postprocessFunc();
 
 	// [RH] Set up hash table
+	auto hashtime = std::chrono::steady_clock::now();
 	InitHashChains ();
+
+	if (Printf)
+	{
+		auto endtime = std::chrono::steady_clock::now();
+		double parsetime = 0;
+		for (auto& file : pending) parsetime += file.ParseTime;
+		Printf(FSMessageLevel::Message, "Read %d files in %.1f ms: %.1f ms reading directories on %u threads (%.1f ms total), %.1f ms merging, %.1f ms hashing\n",
+			(int)filenames.size(), std::chrono::duration<double, std::milli>(endtime - starttime).count(),
+			std::chrono::duration<double, std::milli>(mergetime - starttime).count(), numthreads, parsetime,
+			std::chrono::duration<double, std::milli>(hashtime - mergetime).count(),
+			std::chrono::duration<double, std::milli>(endtime - hashtime).count());
+	}
 	return true;
 }
 
@@ -329,7 +444,21 @@ int FileSystem::AddFromBuffer(const char* name, char* data, int size, int id, in
 
 void FileSystem::AddFile (const char *filename, FileReader *filer, LumpFilterInfo* filter, FileSystemMessageFunc Printf)
 {
-	int startlump;
+	auto resfile = OpenFile(filename, filer, filter, Printf);
+	if (resfile != nullptr) AddResourceFile(filename, resfile, filter, Printf);
+}
+
+//==========================================================================
+//
+// OpenFile
+//
+// Opens a file or directory and reads its directory. This does not touch
+// the lump directory so it may be called from any thread.
+//
+//==========================================================================
+
+FResourceFile* FileSystem::OpenFile(const char* filename, FileReader* filer, LumpFilterInfo* filter, FileSystemMessageFunc Printf)
+{
 	bool isdir = false;
 	FileReader filereader;
 
@@ -343,64 +472,67 @@ void FileSystem::AddFile (const char *filename, FileReader *filer, LumpFilterInf
 				Printf(FSMessageLevel::Error, "%s: File or Directory not found\n", filename);
 				PrintLastError(Printf);
 			}
-			return;
+			return nullptr;
 		}
 
 		if (!isdir)
 		{
-			if (!filereader.OpenFile(filename))
+			bool opened = filter != nullptr && filter->mapFiles ? filereader.OpenFileMapped(filename) : filereader.OpenFile(filename);
+			if (!opened)
 			{ // Didn't find file
 				if (Printf)
 				{
 					Printf(FSMessageLevel::Error, "%s: File not found\n", filename);
 					PrintLastError(Printf);
 				}
-				return;
+				return nullptr;
 			}
 		}
 	}
 	else filereader = std::move(*filer);
 
-	startlump = NumEntries;
-
-	FResourceFile *resfile;
-
-
 	if (!isdir)
-		resfile = FResourceFile::OpenResourceFile(filename, filereader, false, filter, Printf, stringpool);
+		return FResourceFile::OpenResourceFile(filename, filereader, false, filter, Printf, stringpool);
 	else
-		resfile = FResourceFile::OpenDirectory(filename, filter, Printf, stringpool);
+		return FResourceFile::OpenDirectory(filename, filter, Printf, stringpool);
+}
 
-	if (resfile != NULL)
-	{
-		if (Printf) 
-			Printf(FSMessageLevel::Message, "adding %s, %d lumps\n", filename, resfile->EntryCount());
+//==========================================================================
+//
+// AddResourceFile
+//
+// Appends an opened file's lumps to the lump directory, followed by the
+// contents of any archives embedded in it.
+//
+//==========================================================================
 
-		uint32_t lumpstart = (uint32_t)FileInfo.size();
+void FileSystem::AddResourceFile(const char* filename, FResourceFile* resfile, LumpFilterInfo* filter, FileSystemMessageFunc Printf)
+{
+	if (Printf) 
+		Printf(FSMessageLevel::Message, "adding %s, %d lumps\n", filename, resfile->EntryCount());
 
-		resfile->SetFirstLump(lumpstart);
-		Files.push_back(resfile);
-		for (int i = 0; i < resfile->EntryCount(); i++)
-		{
-			FileInfo.resize(FileInfo.size() + 1);
-			FileSystem::LumpRecord* lump_p = &FileInfo.back();
-			lump_p->SetFromLump(resfile, i, (int)Files.size() - 1, stringpool);
-		}
+	uint32_t lumpstart = (uint32_t)FileInfo.size();
 
-		for (int i = 0; i < resfile->EntryCount(); i++)
+	resfile->SetFirstLump(lumpstart);
+	Files.push_back(resfile);
+	for (int i = 0; i < resfile->EntryCount(); i++)
+	{
+		FileInfo.resize(FileInfo.size() + 1);
+		FileSystem::LumpRecord* lump_p = &FileInfo.back();
+		lump_p->SetFromLump(resfile, i, (int)Files.size() - 1, stringpool);
+	}
+
+	for (int i = 0; i < resfile->EntryCount(); i++)
+	{
+		int flags = resfile->GetEntryFlags(i);
+		if (flags & RESFF_EMBEDDED)
 		{
-			int flags = resfile->GetEntryFlags(i);
-			if (flags & RESFF_EMBEDDED)
-			{
-				std::string path = filename;
-				path += ':';
-				path += resfile->getName(i);
-				auto embedded = resfile->GetEntryReader(i, READER_CACHED);
-				AddFile(path.c_str(), &embedded, filter, Printf);
-			}
+			std::string path = filename;
+			path += ':';
+			path += resfile->getName(i);
+			auto embedded = resfile->GetEntryReader(i, READER_CACHED);
+			AddFile(path.c_str(), &embedded, filter, Printf);
 		}
-
-		return;
 	}
 }
 
@@ -33,6 +33,7 @@
 */
 
 #include "fs_findfile.h"
+#include <stdio.h>
 #include <string.h>
 #include <vector>
 #include <sys/stat.h>
@@ -424,4 +425,64 @@ bool FS_DirEntryExists(const char* pathname, bool* isdir)
 	return res;
 }
 
+//==========================================================================
+//
+// GetFileInfo
+//
+// Returns size and modification time of a regular file.
+//
+//==========================================================================
+
+bool FS_GetFileInfo(const char* pathname, uint64_t* size, int64_t* mtime)
+{
+	if (pathname == NULL || *pathname == 0)
+		return false;
+
+#ifndef _WIN32
+	struct stat info;
+	bool res = stat(pathname, &info) == 0;
+#else
+	auto wstr = toWide(pathname);
+	struct _stat64 info;
+	bool res = _wstat64(wstr.c_str(), &info) == 0;
+#endif
+	if (!res || (info.st_mode & S_IFDIR)) return false;
+	if (size) *size = (uint64_t)info.st_size;
+	if (mtime) *mtime = (int64_t)info.st_mtime;
+	return true;
+}
+
+//==========================================================================
+//
+// ReplaceFile
+//
+// Renames a file, replacing the target if it already exists. Readers of
+// the target see either the old or the new file, never a partial one.
+//
+//==========================================================================
+
+bool FS_ReplaceFile(const char* from, const char* to)
+{
+#ifndef _WIN32
+	return rename(from, to) == 0;
+#else
+	return !!MoveFileExW(toWide(from).c_str(), toWide(to).c_str(), MOVEFILE_REPLACE_EXISTING);
+#endif
+}
+
+//==========================================================================
+//
+// RemoveFile
+//
+//==========================================================================
+
+bool FS_RemoveFile(const char* pathname)
+{
+#ifndef _WIN32
+	return remove(pathname) == 0;
+#else
+	return _wremove(toWide(pathname).c_str()) == 0;
+#endif
+}
+
 }
@@ -105,6 +105,13 @@ StringPool::Block *StringPool::AddBlock(size_t size)
 }
 
 void *StringPool::Alloc(size_t size)
+{
+	if (!shared) return AllocLocked(size);
+	std::lock_guard<std::mutex> lock(mutex);
+	return AllocLocked(size);
+}
+
+void *StringPool::AllocLocked(size_t size)
 {
 	Block *block;
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <mutex>
+
 namespace FileSys {
 // Storage for all the static strings the file system must hold.
 class StringPool
@@ -18,9 +20,11 @@ protected:
 	struct Block;
 
 	Block *AddBlock(size_t size);
+	void *AllocLocked(size_t size);
 
 	Block *TopBlock;
 	size_t BlockSize;
+	std::mutex mutex;	// shared pools get filled by the archive loader threads.
 public:
 	bool shared;
 };
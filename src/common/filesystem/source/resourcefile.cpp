@@ -35,6 +35,8 @@
 */
 
 #include <algorithm>
+#include <chrono>
+#include <stddef.h>
 #include <miniz.h>
 #include "resourcefile.h"
 #include "md5.hpp"
@@ -343,6 +345,207 @@ void FResourceFile::GenerateHash()
 	}
 }
 
+//==========================================================================
+//
+// Archive index cache
+//
+// Reading the directory of a large archive means decoding every name in it,
+// and for 7z also decompressing the header database. Both only depend on
+// the archive's content so the result is stored as a flat table in
+// filter->indexCachePath. A cached index is used if the archive's size,
+// modification time and the hash of its directory still match. The caller
+// passes where the directory is: for a zip this is the central directory
+// up to the end record, for a 7z the header database. Both contain the
+// CRCs of all entries, so changing any file in the archive also changes
+// the hash.
+//
+// Cache files are written under a temporary name and renamed, because
+// several loader threads or engine instances may save the same one at
+// the same time. Only the most recently written ones are kept.
+//
+// The table is what the loader produces before PostProcessArchive, so the
+// game filters get applied each time as before.
+//
+//==========================================================================
+
+struct FArchiveIndexHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint64_t FileSize;
+	int64_t FileTime;
+	uint8_t Digest[16];
+	uint32_t NumEntries;
+	uint32_t NameSize;
+};
+
+struct FArchiveIndexEntry
+{
+	uint64_t Length;
+	uint64_t CompressedSize;
+	uint64_t Position;
+	int32_t ResourceID;
+	uint32_t CRC32;
+	uint16_t Flags;
+	uint16_t Method;
+	int16_t Namespace;
+	uint16_t NameLength;
+};
+
+static const uint32_t INDEX_MAGIC = 0x58495346;	// 'FSIX'
+static const uint32_t INDEX_VERSION = 2;
+static const size_t INDEX_HASHSIZE = 65536;
+static const size_t INDEX_MAXFILES = 256;
+
+bool FResourceFile::GetIndexStamp(LumpFilterInfo* filter, uint64_t dirpos, uint64_t dirsize, std::string& cachefile, FArchiveIndexHeader& header)
+{
+	using namespace FileSys::md5;
+
+	if (filter == nullptr || filter->indexCachePath.empty() || !Reader.isOpen()) return false;
+
+	// embedded archives have no time stamp of their own and are usually small, so they do not get cached.
+	memset(&header, 0, sizeof(header));
+	if (!FS_GetFileInfo(FileName, &header.FileSize, &header.FileTime)) return false;
+	if (header.FileSize != (uint64_t)Reader.GetLength()) return false;
+	if (dirsize == 0 || dirpos > header.FileSize || dirsize > header.FileSize - dirpos) return false;
+	header.Magic = INDEX_MAGIC;
+	header.Version = INDEX_VERSION;
+
+	std::vector<uint8_t> buffer((size_t)std::min<uint64_t>(dirsize, INDEX_HASHSIZE));
+	md5_state_t state;
+	md5_init(&state);
+	md5_append(&state, (const uint8_t*)&dirpos, sizeof(dirpos));
+	Reader.Seek(dirpos, FileReader::SeekSet);
+	for (uint64_t left = dirsize; left > 0;)
+	{
+		size_t chunk = (size_t)std::min<uint64_t>(left, buffer.size());
+		if (Reader.Read(buffer.data(), chunk) != (ptrdiff_t)chunk) return false;
+		md5_append(&state, buffer.data(), (unsigned)chunk);
+		left -= chunk;
+	}
+	md5_finish(&state, header.Digest);
+	Reader.Seek(0, FileReader::SeekSet);
+
+	// the index is looked up by the archive's full path.
+	auto fullpath = FS_FullPath(FileName);
+	uint8_t namedigest[16];
+	md5_init(&state);
+	md5_append(&state, (const uint8_t*)fullpath.c_str(), (unsigned)fullpath.length());
+	md5_finish(&state, namedigest);
+	char hex[33];
+	for (int i = 0; i < 16; i++) snprintf(hex + 2 * i, 3, "%02x", namedigest[i]);
+	cachefile = filter->indexCachePath + "/archive-" + hex + ".bin";
+	return true;
+}
+
+bool FResourceFile::LoadIndex(LumpFilterInfo* filter, uint64_t dirpos, uint64_t dirsize)
+{
+	std::string cachefile;
+	FArchiveIndexHeader header, cached;
+	if (!GetIndexStamp(filter, dirpos, dirsize, cachefile, header)) return false;
+
+	FileReader fr;
+	if (!fr.OpenFile(cachefile.c_str())) return false;
+	if (fr.Read(&cached, sizeof(cached)) != sizeof(cached)) return false;
+	if (memcmp(&cached, &header, offsetof(FArchiveIndexHeader, NumEntries)) != 0) return false;
+	if ((uint64_t)fr.GetLength() != sizeof(cached) + (uint64_t)cached.NumEntries * sizeof(FArchiveIndexEntry) + cached.NameSize) return false;
+
+	std::vector<FArchiveIndexEntry> entries(cached.NumEntries);
+	if (cached.NumEntries > 0) fr.Read(entries.data(), cached.NumEntries * sizeof(FArchiveIndexEntry));
+	// the names are stored back to back, each with a terminating 0, so the whole block can go into the string pool at once.
+	char* names = (char*)stringpool->Alloc(cached.NameSize + 1);
+	fr.Read(names, cached.NameSize);
+	names[cached.NameSize] = 0;
+
+	AllocateEntries(cached.NumEntries);
+	size_t nameofs = 0;
+	for (uint32_t i = 0; i < cached.NumEntries; i++)
+	{
+		auto& e = entries[i];
+		if (nameofs + e.NameLength >= cached.NameSize || names[nameofs + e.NameLength] != 0) return false;
+		Entries[i].FileName = names + nameofs;
+		Entries[i].Length = (size_t)e.Length;
+		Entries[i].CompressedSize = (size_t)e.CompressedSize;
+		Entries[i].Position = (size_t)e.Position;
+		Entries[i].ResourceID = e.ResourceID;
+		Entries[i].CRC32 = e.CRC32;
+		Entries[i].Flags = e.Flags;
+		Entries[i].Method = e.Method;
+		Entries[i].Namespace = e.Namespace;
+		nameofs += e.NameLength + 1;
+	}
+	return true;
+}
+
+static void PruneIndexCache(const std::string& path)
+{
+	FileList list;
+	if (!ScanDirectory(list, path.c_str(), "archive-*.bin", true)) return;
+
+	std::vector<std::pair<int64_t, const char*>> files;
+	for (auto& entry : list)
+	{
+		int64_t mtime;
+		if (!entry.isDirectory && FS_GetFileInfo(entry.FilePath.c_str(), nullptr, &mtime))
+			files.push_back({ mtime, entry.FilePath.c_str() });
+	}
+	if (files.size() <= INDEX_MAXFILES) return;
+
+	std::sort(files.begin(), files.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+	for (size_t i = INDEX_MAXFILES; i < files.size(); i++)
+	{
+		FS_RemoveFile(files[i].second);
+	}
+}
+
+void FResourceFile::SaveIndex(LumpFilterInfo* filter, uint64_t dirpos, uint64_t dirsize)
+{
+	std::string cachefile;
+	FArchiveIndexHeader header;
+	if (!GetIndexStamp(filter, dirpos, dirsize, cachefile, header)) return;
+
+	std::vector<FArchiveIndexEntry> entries(NumLumps);
+	std::string names;
+	for (uint32_t i = 0; i < NumLumps; i++)
+	{
+		auto& e = entries[i];
+		size_t len = strlen(Entries[i].FileName);
+		if (len > UINT16_MAX) return;
+		memset(&e, 0, sizeof(e));
+		e.Length = Entries[i].Length;
+		e.CompressedSize = Entries[i].CompressedSize;
+		e.Position = Entries[i].Position;
+		e.ResourceID = Entries[i].ResourceID;
+		e.CRC32 = Entries[i].CRC32;
+		e.Flags = Entries[i].Flags;
+		e.Method = Entries[i].Method;
+		e.Namespace = Entries[i].Namespace;
+		e.NameLength = (uint16_t)len;
+		names.append(Entries[i].FileName, len + 1);
+	}
+	header.NumEntries = NumLumps;
+	header.NameSize = (uint32_t)names.size();
+
+	// The temporary name must be unique among all threads and processes that might write this file right now.
+	char unique[48];
+	snprintf(unique, sizeof(unique), ".%p-%llx.tmp", (void*)this, (unsigned long long)std::chrono::steady_clock::now().time_since_epoch().count());
+	std::string tempfile = cachefile + unique;
+
+	auto fw = FileWriter::Open(tempfile.c_str());
+	if (fw == nullptr) return;
+	size_t written = fw->Write(&header, sizeof(header));
+	if (NumLumps > 0) written += fw->Write(entries.data(), NumLumps * sizeof(FArchiveIndexEntry));
+	written += fw->Write(names.data(), names.size());
+	delete fw;
+
+	if (written != sizeof(header) + NumLumps * sizeof(FArchiveIndexEntry) + names.size() || !FS_ReplaceFile(tempfile.c_str(), cachefile.c_str()))
+	{
+		FS_RemoveFile(tempfile.c_str());
+		return;
+	}
+	PruneIndexCache(filter->indexCachePath);
+}
+
 //==========================================================================
 //
 // FResourceFile :: PostProcessArchive
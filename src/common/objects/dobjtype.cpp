@@ -45,6 +45,7 @@
 #include "vm.h"
 #include "symbols.h"
 #include "types.h"
+#include "jit.h"
 
 // MACROS ------------------------------------------------------------------
 
@@ -245,6 +246,8 @@ void PClass::StaticShutdown ()
 		*p = nullptr;
 	}
 	FunctionPtrList.Clear();
+	// The JIT profile needs to look at the compiled functions, so it has to be written before they go away.
+	SaveJitProfile();
 	VMFunction::DeleteAll();
 	// From this point onward no scripts may be called anymore because the data needed by the VM is getting deleted now.
 	// This flags DObject::Destroy not to call any scripted OnDestroy methods anymore.
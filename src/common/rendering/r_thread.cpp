@@ -269,17 +269,21 @@ MemcpyCommand::MemcpyCommand(void *dest, int destpitch, const void *src, int wid
 
 void MemcpyCommand::Execute(DrawerThread *thread)
 {
-	int start = thread->skipped_by_thread(0);
-	int count = thread->count_for_thread(0, height);
-	int sstep = thread->num_cores * srcpitch * pixelsize;
-	int dstep = thread->num_cores * destpitch * pixelsize;
 	int size = width * pixelsize;
-	uint8_t *d = (uint8_t*)dest + start * destpitch * pixelsize;
-	const uint8_t *s = (const uint8_t*)src + start * srcpitch * pixelsize;
-	for (int i = 0; i < count; i++)
+	while (true)
 	{
-		memcpy(d, s, size);
-		d += dstep;
-		s += sstep;
+		int start = nextband.fetch_add(1) * BandHeight;
+		if (start >= height)
+			break;
+
+		int count = min((int)BandHeight, height - start);
+		uint8_t *d = (uint8_t*)dest + start * destpitch * pixelsize;
+		const uint8_t *s = (const uint8_t*)src + start * srcpitch * pixelsize;
+		for (int i = 0; i < count; i++)
+		{
+			memcpy(d, s, size);
+			d += destpitch * pixelsize;
+			s += srcpitch * pixelsize;
+		}
 	}
 }
@@ -26,6 +26,7 @@
 #include <memory>
 #include <thread>
 #include <mutex>
+#include <atomic>
 #include <condition_variable>
 
 #include "c_cvars.h"
@@ -122,6 +123,10 @@ private:
 };
 
 // Copy finished rows to video memory
+//
+// The rows are handed out in bands that each thread grabs as soon as it is
+// done with the previous one, so a thread that gets delayed does not hold
+// up the others.
 class MemcpyCommand : public DrawerCommand
 {
 public:
@@ -129,6 +134,9 @@ public:
 	void Execute(DrawerThread *thread);
 
 private:
+	enum { BandHeight = 16 };
+
+	std::atomic<int> nextband{};
 	void *dest;
 	const void *src;
 	int destpitch;
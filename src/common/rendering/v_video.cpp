@@ -145,6 +145,8 @@ CUSTOM_CVAR(Int, uiscale, 0, CVAR_ARCHIVE | CVAR_NOINITCALL)
 
 
 EXTERN_CVAR(Bool, r_blendmethod)
+EXTERN_CVAR(Int, vid_defwidth)
+EXTERN_CVAR(Int, vid_defheight)
 
 int active_con_scale();
 
@@ -169,6 +171,42 @@ public:
 	float Gamma;
 };
 
+//==========================================================================
+//
+// Null video backend (-novideo)
+//
+// Stands in for the platform's video backend when there is no display,
+// e.g. on a CI machine. It has no window and no GPU resources, so nothing
+// gets presented. The software renderer can still draw into canvases of
+// its own, which is what the swbench command does.
+//
+//==========================================================================
+
+class DNullFrameBuffer : public DFrameBuffer
+{
+	typedef DFrameBuffer Super;
+public:
+	DNullFrameBuffer(int width, int height)
+		: DFrameBuffer(0, 0)
+	{
+		SetVirtualSize(width, height);
+	}
+	void Update() override {}
+	bool IsFullscreen() override { return false; }
+	int GetClientWidth() override { return GetWidth(); }
+	int GetClientHeight() override { return GetHeight(); }
+	void InitializeState() override {}
+};
+
+class FNullVideo : public IVideo
+{
+public:
+	DFrameBuffer *CreateFrameBuffer() override
+	{
+		return new DNullFrameBuffer(vid_defwidth, vid_defheight);
+	}
+};
+
 int DisplayWidth, DisplayHeight;
 
 // [RH] The framebuffer is no longer a mere byte array.
@@ -399,7 +437,10 @@ void V_Init2()
 	ticker->SetGenericRepDefault(val, CVAR_Bool);
 
 
-	I_InitGraphics();
+	if (Args->CheckParm("-novideo"))
+		Video = new FNullVideo;
+	else
+		I_InitGraphics();
 
 	Video->SetResolution();	// this only fails via exceptions.
 	Printf ("Resolution: %d x %d\n", SCREENWIDTH, SCREENHEIGHT);
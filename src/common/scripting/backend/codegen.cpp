@@ -10184,6 +10184,16 @@ ExpEmit FxVMFunctionCall::Emit(VMFunctionBuilder *build)
 	ArgList.DeleteAndClear();
 	ArgList.ShrinkToFit();
 
+	// A virtual call that no class can override is turned into a direct one. This skips the
+	// vtable lookup in the interpreter and lets the JIT call native functions directly.
+	// The null check is kept so that calling through a null pointer still aborts the same way.
+	// Calls that can still reach an override keep the VTBL, which already is a single indexed load,
+	// so a per-site class cache would not make them faster.
+	if (!staticcall && Self->ValueType->isObjectPointer() && !FunctionBuildList.IsOverridden(static_cast<PObjectPointer*>(Self->ValueType)->PointedClass(), vmfunc))
+	{
+		build->Emit(OP_NULLCHECK, selfemit.RegNum, 0, 0);
+		staticcall = true;
+	}
 	if (!staticcall) emitters.SetVirtualReg(selfemit.RegNum);
 
 	PPrototype * proto = FnPtrCall ? static_cast<PPrototype*>(static_cast<PFunctionPointer*>(Self->ValueType)->PointedType) : vmfunc->Proto;
@@ -38,9 +38,18 @@
 #include "c_cvars.h"
 #include "jit.h"
 #include "filesystem.h"
+#include "i_specialpaths.h"
+#include "md5.h"
+#include "version.h"
+#include "printf.h"
+#include "cmdlib.h"
+#include "fs_findfile.h"
 
 CVAR(Bool, strictdecorate, false, CVAR_GLOBALCONFIG | CVAR_ARCHIVE)
 CVAR(Bool, warningstoerrors, false, CVAR_GLOBALCONFIG | CVAR_ARCHIVE)
+CVAR(Bool, vm_optimize, true, CVAR_GLOBALCONFIG | CVAR_ARCHIVE)	// only affects functions compiled after it changes
+CVAR(Bool, vm_devirtualize, true, CVAR_GLOBALCONFIG | CVAR_ARCHIVE)	// same here
+CVAR(Bool, vm_jit_profile, false, CVAR_GLOBALCONFIG | CVAR_ARCHIVE)	// only compile functions ahead of time that were used before with the same scripts
 
 EXTERN_CVAR(Bool, vm_jit)
 EXTERN_CVAR(Bool, vm_jit_aot)
@@ -116,6 +125,8 @@ void VMFunctionBuilder::EndStatement()
 
 void VMFunctionBuilder::MakeFunction(VMScriptFunction *func)
 {
+	if (vm_optimize) Optimize();
+
 	func->Alloc(Code.Size(), IntConstantList.Size(), FloatConstantList.Size(), StringConstantList.Size(), AddressConstantList.Size(), LineNumbers.Size());
 
 	// Copy code block.
@@ -154,6 +165,271 @@ void VMFunctionBuilder::MakeFunction(VMScriptFunction *func)
 	assert(ActiveParam == 0);
 }
 
+//==========================================================================
+//
+// VMFunctionBuilder :: Optimize
+//
+// Cleans up the finished code before it gets copied into the function.
+// The code generator emits each expression on its own, so it leaves
+// jumps to jumps, jumps to the next instruction, self moves, moves whose
+// result is overwritten before it is read and repeated constant loads
+// behind, which all cost a dispatch in the interpreter and a few
+// instructions in the JIT.
+//
+// This never touches the JMP after a compare or TEST, the jump table
+// after an IJMP or the RESULTs after a CALL, because those are read as
+// part of the preceding instruction.
+//
+//==========================================================================
+
+static bool SkipsNext(int op)
+{
+	return (OpInfo[op].Mode & MODE_ATYPE) == MODE_ACMP || op == OP_TEST || op == OP_TESTN || op == OP_CMPS;
+}
+
+// Instructions that only compute rA from rB and rC and have no other effect on registers.
+// Everything they read is described by the B and C operand modes. Vector operands are
+// left out because they cover several registers.
+static bool IsPureDef(int op)
+{
+	switch (op)
+	{
+	case OP_MOVE:	case OP_MOVEF:	case OP_MOVES:	case OP_MOVEA:
+	case OP_LI:		case OP_LK:		case OP_LKF:	case OP_LKS:	case OP_LKP:
+	case OP_LK_R:	case OP_LKF_R:	case OP_LKS_R:	case OP_LKP_R:
+	case OP_META:	case OP_CLSS:
+	case OP_LB:		case OP_LB_R:	case OP_LH:		case OP_LH_R:	case OP_LW:		case OP_LW_R:
+	case OP_LBU:	case OP_LBU_R:	case OP_LHU:	case OP_LHU_R:	case OP_LSP:	case OP_LSP_R:
+	case OP_LDP:	case OP_LDP_R:	case OP_LS:		case OP_LS_R:	case OP_LO:		case OP_LO_R:
+	case OP_LP:		case OP_LP_R:	case OP_LCS:	case OP_LCS_R:	case OP_LBIT:
+	case OP_CONCAT:	case OP_LENS:
+	case OP_SLL_RR:	case OP_SLL_RI:	case OP_SLL_KR:	case OP_SRL_RR:	case OP_SRL_RI:	case OP_SRL_KR:
+	case OP_SRA_RR:	case OP_SRA_RI:	case OP_SRA_KR:
+	case OP_ADD_RR:	case OP_ADD_RK:	case OP_ADDI:	case OP_SUB_RR:	case OP_SUB_RK:	case OP_SUB_KR:
+	case OP_MUL_RR:	case OP_MUL_RK:	case OP_DIV_RR:	case OP_DIV_RK:	case OP_DIV_KR:
+	case OP_DIVU_RR:case OP_DIVU_RK:case OP_DIVU_KR:case OP_MOD_RR:	case OP_MOD_RK:	case OP_MOD_KR:
+	case OP_MODU_RR:case OP_MODU_RK:case OP_MODU_KR:
+	case OP_AND_RR:	case OP_AND_RK:	case OP_OR_RR:	case OP_OR_RK:	case OP_XOR_RR:	case OP_XOR_RK:
+	case OP_MIN_RR:	case OP_MIN_RK:	case OP_MAX_RR:	case OP_MAX_RK:
+	case OP_MINU_RR:case OP_MINU_RK:case OP_MAXU_RR:case OP_MAXU_RK:
+	case OP_ABS:	case OP_NEG:	case OP_NOT:
+	case OP_ADDF_RR:case OP_ADDF_RK:case OP_SUBF_RR:case OP_SUBF_RK:case OP_SUBF_KR:
+	case OP_MULF_RR:case OP_MULF_RK:case OP_DIVF_RR:case OP_DIVF_RK:case OP_DIVF_KR:
+	case OP_MODF_RR:case OP_MODF_RK:case OP_MODF_KR:case OP_POWF_RR:case OP_POWF_RK:case OP_POWF_KR:
+	case OP_MINF_RR:case OP_MINF_RK:case OP_MAXF_RR:case OP_MAXF_RK:case OP_ATAN2:	case OP_FLOP:
+	case OP_ADDA_RR:case OP_ADDA_RK:case OP_SUBA:
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+static bool ReadsRegister(const VMOP &op, int regtype, int regnum)
+{
+	int btype = (OpInfo[op.op].Mode & MODE_BTYPE) >> MODE_BSHIFT;
+	int ctype = (OpInfo[op.op].Mode & MODE_CTYPE) >> MODE_CSHIFT;
+	return (btype == regtype && op.b == regnum) || (ctype == regtype && op.c == regnum);
+}
+
+void VMFunctionBuilder::Optimize()
+{
+	const unsigned count = Code.Size();
+	if (count == 0) return;
+
+	TArray<bool> fixed(count, true);	// instructions that are read together with their predecessor
+	TArray<bool> target(count, true);
+	for (unsigned i = 0; i < count; i++)
+	{
+		fixed[i] = false;
+		target[i] = false;
+	}
+	for (unsigned i = 1; i < count; i++)
+	{
+		if (SkipsNext(Code[i - 1].op))
+		{
+			fixed[i] = true;
+		}
+		else if (Code[i - 1].op == OP_IJMP)
+		{
+			for (unsigned j = i; j < count && Code[j].op == OP_JMP; j++) fixed[j] = true;
+		}
+		else if (Code[i - 1].op == OP_CALL || Code[i - 1].op == OP_CALL_K)
+		{
+			for (unsigned j = i; j < count && j < i + Code[i - 1].c; j++) fixed[j] = true;
+		}
+	}
+
+	// Thread jumps that land on another jump straight to the final target.
+	for (unsigned i = 0; i < count; i++)
+	{
+		if (Code[i].op != OP_JMP) continue;
+		int dest = int(i) + 1 + Code[i].i24;
+		for (int hops = 0; hops < 16 && dest >= 0 && dest < int(count) && Code[dest].op == OP_JMP && dest != int(i); hops++)
+		{
+			dest = dest + 1 + Code[dest].i24;
+		}
+		if (dest >= 0 && dest < int(count))
+		{
+			Code[i].i24 = dest - int(i) - 1;
+			target[dest] = true;
+		}
+	}
+
+	// Find everything that can be dropped.
+	TArray<bool> remove(count, true);
+	unsigned gen = 1;
+	TArray<unsigned> knowngen(4 * 256, true);
+	TArray<VM_UWORD> knownload(4 * 256, true);
+	for (auto &g : knowngen) g = 0;
+	unsigned numremoved = 0;
+
+	for (unsigned i = 0; i < count; i++)
+	{
+		const VMOP &op = Code[i];
+		bool drop = false;
+
+		if (target[i] || fixed[i] || (i > 0 && (fixed[i - 1] || Code[i - 1].op == OP_JMP)))
+		{
+			gen++;	// start of a new basic block or conditionally executed, nothing is known about the registers
+		}
+
+		if (!fixed[i])
+		{
+			switch (op.op)
+			{
+			case OP_NOP:
+				drop = true;
+				break;
+
+			case OP_JMP:
+				drop = op.i24 == 0;
+				break;
+
+			case OP_MOVE:
+			case OP_MOVEF:
+			case OP_MOVES:
+			case OP_MOVEA:
+			case OP_MOVEV2:
+			case OP_MOVEV3:
+			case OP_MOVEV4:
+				drop = op.a == op.b;
+				break;
+
+			case OP_LI:
+			case OP_LK:
+			case OP_LKF:
+			case OP_LKS:
+			case OP_LKP:
+			{
+				int slot = ((OpInfo[op.op].Mode & MODE_ATYPE) >> MODE_ASHIFT) * 256 + op.a;
+				drop = knowngen[slot] == gen && knownload[slot] == op.word;
+				break;
+			}
+
+			default:
+				break;
+			}
+		}
+		remove[i] = drop;
+		if (drop)
+		{
+			numremoved++;
+			continue;
+		}
+
+		// Track which registers hold a constant. Anything that may write registers in
+		// a way the A operand does not describe invalidates all of them.
+		int atype = (OpInfo[op.op].Mode & MODE_ATYPE) >> MODE_ASHIFT;
+		switch (op.op)
+		{
+		case OP_LI:
+		case OP_LK:
+		case OP_LKF:
+		case OP_LKS:
+		case OP_LKP:
+			knowngen[atype * 256 + op.a] = gen;
+			knownload[atype * 256 + op.a] = op.word;
+			break;
+
+		case OP_NOP:
+		case OP_PARAM:
+		case OP_PARAMI:
+			break;
+
+		case OP_MOVEV2:
+		case OP_MOVEV3:
+		case OP_MOVEV4:
+		case OP_CALL:
+		case OP_CALL_K:	// the callee may write registers passed by address
+			gen++;
+			break;
+
+		default:
+			if (atype == MODE_I || atype == MODE_F || atype == MODE_S || atype == MODE_P)
+			{
+				knowngen[atype * 256 + op.a] = 0;
+			}
+			else
+			{
+				gen++;
+			}
+			break;
+		}
+	}
+
+	// Drop moves whose result is overwritten later in the same basic block before anything reads it.
+	// Only pure instructions are looked through, anything else may read the register in a way the
+	// operand modes do not describe.
+	for (unsigned i = 0; i < count; i++)
+	{
+		const VMOP &op = Code[i];
+		if (remove[i] || fixed[i] || (op.op != OP_MOVE && op.op != OP_MOVEF && op.op != OP_MOVES && op.op != OP_MOVEA)) continue;
+
+		int atype = (OpInfo[op.op].Mode & MODE_ATYPE) >> MODE_ASHIFT;
+		for (unsigned j = i + 1; j < count && !target[j] && !fixed[j]; j++)
+		{
+			if (remove[j]) continue;
+			if (!IsPureDef(Code[j].op) || ReadsRegister(Code[j], atype, op.a)) break;
+			if (Code[j].a == op.a && ((OpInfo[Code[j].op].Mode & MODE_ATYPE) >> MODE_ASHIFT) == atype)
+			{
+				remove[i] = true;
+				numremoved++;
+				break;
+			}
+		}
+	}
+
+	if (numremoved == 0) return;
+
+	// Compact the code and fix up everything that refers to instruction indices.
+	TArray<unsigned> newindex(count + 1, true);
+	unsigned n = 0;
+	for (unsigned i = 0; i < count; i++)
+	{
+		newindex[i] = n;
+		if (!remove[i]) n++;
+	}
+	newindex[count] = n;
+
+	for (unsigned i = 0; i < count; i++)
+	{
+		if (remove[i] || Code[i].op != OP_JMP) continue;
+		int dest = int(i) + 1 + Code[i].i24;
+		Code[i].i24 = int(newindex[dest]) - int(newindex[i]) - 1;
+	}
+	for (unsigned i = 0; i < count; i++)
+	{
+		if (!remove[i]) Code[newindex[i]] = Code[i];
+	}
+	Code.Resize(n);
+
+	for (auto &line : LineNumbers)
+	{
+		line.InstructionIndex = (uint16_t)newindex[min<unsigned>(line.InstructionIndex, count)];
+	}
+}
+
 //==========================================================================
 //
 // VMFunctionBuilder :: FillIntConstants
@@ -836,10 +1112,56 @@ VMFunction *FFunctionBuildList::AddFunction(PNamespace *gnspc, const VersionInfo
 }
 
 
+//==========================================================================
+//
+// FFunctionBuildList :: IsOverridden
+//
+// Checks if any class that can be behind a pointer of the given type
+// replaces the virtual function. If none does, the call can be made
+// directly. This is only valid once all classes have been compiled, which
+// is the case for everything emitted from Build() or later.
+//
+//==========================================================================
+
+bool FFunctionBuildList::IsOverridden(PClass *cls, VMFunction *func)
+{
+	unsigned index = func->VirtualIndex;
+	if (!vm_devirtualize || index == ~0u || (func->VarFlags & VARF_Abstract)) return true;
+
+	auto &known = mOverrides[cls];
+	if (known.Size() <= index)
+	{
+		unsigned oldsize = known.Size();
+		known.Resize(index + 1);
+		memset(&known[oldsize], 0, index + 1 - oldsize);
+	}
+	if (known[index] == 0)
+	{
+		known[index] = 2;
+		for (auto type : PClass::AllClasses)
+		{
+			if (type->IsDescendantOf(cls) && (type->Virtuals.Size() <= index || type->Virtuals[index] != func))
+			{
+				known[index] = 1;
+				break;
+			}
+		}
+	}
+	return known[index] == 1;
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
 void FFunctionBuildList::Build()
 {
 	VMDisassemblyDumper disasmdump(VMDisassemblyDumper::Overwrite);
 
+	mOverrides.Clear();
+
 	for (auto &item : mItems)
 	{
 		// [Player701] Do not emit code for abstract functions
@@ -941,12 +1263,7 @@ void FFunctionBuildList::Build()
 
 				sfunc->Unsafe = ctx.Unsafe;
 
-				#if HAVE_VM_JIT
-					if(vm_jit && vm_jit_aot)
-					{
-						sfunc->JitCompile();
-					}
-				#endif
+				mJitFunctions.Push(sfunc);
 			}
 			catch (CRecoverableError &err)
 			{
@@ -957,6 +1274,13 @@ void FFunctionBuildList::Build()
 		delete item.Code;
 		disasmdump.Flush();
 	}
+	#if HAVE_VM_JIT
+		if(vm_jit && vm_jit_aot)
+		{
+			CompileAheadOfTime();
+		}
+	#endif
+	if (mJitProfileKey.IsEmpty()) mJitFunctions.Clear();
 	VMFunction::CreateRegUseInfo();
 	FScriptPosition::StrictErrors = strictdecorate;
 
@@ -970,6 +1294,148 @@ void FFunctionBuildList::Build()
 	FxAlloc.FreeAllBlocks();
 }
 
+//==========================================================================
+//
+// FFunctionBuildList :: CompileAheadOfTime
+//
+// Normally all functions get compiled here, which is a large part of the
+// startup time for big mods. With vm_jit_profile only the functions that
+// were called during earlier sessions with the exact same script code are
+// compiled up front. Everything else gets compiled on first call, as it
+// would be without vm_jit_aot, so the first session after any script
+// change compiles during play. Only the list of functions is cached, not
+// the compiled code. The profile is written by SaveJitProfile and is only
+// a hint, so a stale or damaged file can never change what the scripts do.
+//
+//==========================================================================
+
+static FString JitProfileName(const FString &key, bool create)
+{
+	FString path = M_GetCachePath(create);
+	path << "/jitprofile-" << key << ".bin";
+	return path;
+}
+
+void FFunctionBuildList::CompileAheadOfTime()
+{
+	if (!vm_jit_profile)
+	{
+		for (auto sfunc : mJitFunctions) sfunc->JitCompile();
+		mJitFunctions.Clear();
+		return;
+	}
+
+	// The key covers the engine version and the generated code of every function in build order,
+	// so the indices in the profile are only ever applied to the same list of functions.
+	MD5Context md5;
+	const char *version = GetVersionString();
+	md5.Update((const uint8_t *)version, (unsigned)strlen(version));
+	for (auto sfunc : mJitFunctions)
+	{
+		md5.Update((const uint8_t *)sfunc->PrintableName, (unsigned)strlen(sfunc->PrintableName) + 1);
+		md5.Update((const uint8_t *)sfunc->Code, sfunc->CodeSize * sizeof(VMOP));
+	}
+	uint8_t digest[16];
+	md5.Final(digest);
+	mJitProfileKey = "";
+	for (auto b : digest) mJitProfileKey.AppendFormat("%02x", b);
+
+	mJitProfileCount = 0;
+	FileReader fr;
+	uint32_t header[2];
+	if (fr.OpenFile(JitProfileName(mJitProfileKey, false).GetChars()) && fr.Read(header, sizeof(header)) == sizeof(header) && header[0] == MAKE_ID('J', 'I', 'T', 'P') && header[1] <= mJitFunctions.Size())
+	{
+		TArray<uint32_t> indices(header[1], true);
+		if (fr.Read(indices.Data(), indices.Size() * sizeof(uint32_t)) == (ptrdiff_t)(indices.Size() * sizeof(uint32_t)))
+		{
+			for (auto index : indices)
+			{
+				if (index < mJitFunctions.Size() && mJitFunctions[index]->ScriptCall == &VMScriptFunction::FirstScriptCall)
+				{
+					mJitFunctions[index]->JitCompile();
+					mJitProfileCount++;
+				}
+			}
+		}
+	}
+	DPrintf(DMSG_NOTIFY, "JIT compiled %u of %u functions ahead of time\n", mJitProfileCount, mJitFunctions.Size());
+}
+
+//==========================================================================
+//
+// FFunctionBuildList :: SaveJitProfile
+//
+// Records which functions have been compiled by now, so that the next
+// session can compile them ahead of time. Must be called before the
+// functions get deleted.
+//
+// Every script change creates a new profile, so only the most recently
+// written ones are kept.
+//
+//==========================================================================
+
+enum { MAX_JIT_PROFILES = 8 };
+
+static void PruneJitProfiles()
+{
+	FileSys::FileList list;
+	FString dir = M_GetCachePath(false);
+	if (!FileSys::ScanDirectory(list, dir.GetChars(), "jitprofile-*.bin", true)) return;
+
+	TArray<std::pair<int64_t, const char *>> profiles;
+	for (auto &entry : list)
+	{
+		uint64_t size;
+		int64_t mtime;
+		if (!entry.isDirectory && FileSys::FS_GetFileInfo(entry.FilePath.c_str(), &size, &mtime))
+			profiles.Push({ mtime, entry.FilePath.c_str() });
+	}
+	if (profiles.Size() <= MAX_JIT_PROFILES) return;
+
+	std::sort(profiles.begin(), profiles.end(), [](const auto &a, const auto &b) { return a.first > b.first; });
+	for (unsigned i = MAX_JIT_PROFILES; i < profiles.Size(); i++)
+	{
+		RemoveFile(profiles[i].second);
+	}
+}
+
+void FFunctionBuildList::SaveJitProfile()
+{
+	if (mJitProfileKey.IsNotEmpty())
+	{
+		TArray<uint32_t> indices;
+		for (unsigned i = 0; i < mJitFunctions.Size(); i++)
+		{
+			auto sfunc = mJitFunctions[i];
+			auto entry = sfunc->ProfiledCall != nullptr ? sfunc->ProfiledCall : sfunc->ScriptCall;
+			if (entry != &VMScriptFunction::FirstScriptCall) indices.Push(i);
+		}
+
+		// Functions are only ever added to the set, so an unchanged size means there is nothing new.
+		if (indices.Size() > mJitProfileCount)
+		{
+			FileWriter *fw = FileWriter::Open(JitProfileName(mJitProfileKey, true).GetChars());
+			if (fw != nullptr)
+			{
+				uint32_t header[2] = { MAKE_ID('J', 'I', 'T', 'P'), indices.Size() };
+				fw->Write(header, sizeof(header));
+				fw->Write(indices.Data(), indices.Size() * sizeof(uint32_t));
+				delete fw;
+				PruneJitProfiles();
+			}
+		}
+	}
+	mJitProfileKey = "";
+	mJitProfileCount = 0;
+	mJitFunctions.Clear();
+	mJitFunctions.ShrinkToFit();
+}
+
+void SaveJitProfile()
+{
+	FunctionBuildList.SaveJitProfile();
+}
+
 void FFunctionBuildList::DumpJit(bool include_gzdoom_pk3)
 {
 #ifdef HAVE_VM_JIT
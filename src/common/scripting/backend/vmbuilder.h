@@ -111,6 +111,8 @@ public:
 	TArray<FxLocalVariableDeclaration *> ConstructedStructs;
 
 private:
+	void Optimize();
+
 	TArray<FStatementInfo> LineNumbers;
 	TArray<FxExpression *> StatementStack;
 
@@ -159,12 +161,19 @@ class FFunctionBuildList
 	};
 
 	TArray<Item> mItems;
+	TMap<PClass *, TArray<uint8_t>> mOverrides;	// per class and virtual index: 0 = unknown, 1 = overridden, 2 = not overridden
+	TArray<VMScriptFunction *> mJitFunctions;	// all built functions in build order, kept for the JIT profile
+	FString mJitProfileKey;
+	unsigned mJitProfileCount = 0;
 
 	void DumpJit(bool include_gzdoom_pk3);
+	void CompileAheadOfTime();
 
 public:
 	VMFunction *AddFunction(PNamespace *curglobals, const VersionInfo &ver, PFunction *func, FxExpression *code, const FString &name, bool fromdecorate, int currentstate, int statecnt, int lumpnum);
+	bool IsOverridden(PClass *cls, VMFunction *func);
 	void Build();
+	void SaveJitProfile();
 };
 
 extern FFunctionBuildList FunctionBuildList;
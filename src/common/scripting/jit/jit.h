@@ -4,5 +4,6 @@
 #include "vmintern.h"
 
 JitFuncPtr JitCompile(VMScriptFunction *func);
+void SaveJitProfile();
 void JitDumpLog(FILE *file, VMScriptFunction *func);
 FString JitCaptureStackTrace(int framesToSkip, bool includeNativeFrames, int maxFrames = -1);
@@ -42,10 +42,42 @@ void JitCompiler::EmitVtbl(const VMOP *op)
 
 void JitCompiler::EmitCALL()
 {
-	EmitVMCall(regA[A], nullptr);
+	if (pc > sfunc->Code && (pc - 1)->op == OP_VTBL)
+		EmitVirtualCall();
+	else
+		EmitVMCall(regA[A], nullptr);
 	pc += C; // Skip RESULTs
 }
 
+void JitCompiler::EmitVirtualCall()
+{
+	using namespace asmjit;
+
+	EmitVtbl(pc - 1);
+
+	// If the function in the vtable is native and has a direct entry point, call that the
+	// same way as EmitNativeCall does. Everything else goes through the generic VM call.
+	auto vmcall = cc.newLabel();
+	auto done = cc.newLabel();
+
+	cc.test(x86::dword_ptr(regA[A], myoffsetof(VMFunction, VarFlags)), VARF_Native);
+	cc.jz(vmcall);
+	auto directcall = newTempIntPtr();
+	cc.mov(directcall, x86::ptr(regA[A], myoffsetof(VMNativeFunction, DirectNativeCall)));
+	cc.test(directcall, directcall);
+	cc.jz(vmcall);
+
+	TArray<const VMOP *> params = ParamOpcodes;
+	EmitDirectNativeCall(directcall, "VirtualNativeCall");
+	cc.jmp(done);
+
+	cc.bind(vmcall);
+	ParamOpcodes = std::move(params);
+	EmitVMCall(regA[A], nullptr);
+
+	cc.bind(done);
+}
+
 void JitCompiler::EmitCALL_K()
 {
 	VMFunction *target = static_cast<VMFunction*>(konsta[A].v);
@@ -78,9 +110,6 @@ void JitCompiler::EmitVMCall(asmjit::X86Gp vmfunc, VMFunction *target)
 	if (numparams != B)
 		I_Error("OP_CALL parameter count does not match the number of preceding OP_PARAM instructions");
 
-	if (pc > sfunc->Code && (pc - 1)->op == OP_VTBL)
-		EmitVtbl(pc - 1);
-
 	FillReturns(pc + 1, C);
 
 	X86Gp paramsptr = newTempIntPtr();
@@ -329,13 +358,6 @@ void JitCompiler::FillReturns(const VMOP *retval, int numret)
 
 void JitCompiler::EmitNativeCall(VMNativeFunction *target)
 {
-	using namespace asmjit;
-
-	if (pc > sfunc->Code && (pc - 1)->op == OP_VTBL)
-	{
-		I_Error("Native direct member function calls not implemented\n");
-	}
-
 	if (target->ImplicitArgs > 0)
 	{
 		auto label = EmitThrowExceptionLabel(X_READ_NIL);
@@ -358,9 +380,16 @@ void JitCompiler::EmitNativeCall(VMNativeFunction *target)
 		cc.jz(label);
 	}
 
+	EmitDirectNativeCall(asmjit::imm_ptr(target->DirectNativeCall), target->PrintableName);
+}
+
+void JitCompiler::EmitDirectNativeCall(const asmjit::Operand_ &callee, const char *comment)
+{
+	using namespace asmjit;
+
 	asmjit::CBNode *cursorBefore = cc.getCursor();
-	auto call = cc.call(imm_ptr(target->DirectNativeCall), CreateFuncSignature());
-	call->setInlineComment(target->PrintableName);
+	auto call = cc.addCall(X86Inst::kIdCall, callee, CreateFuncSignature());
+	call->setInlineComment(comment);
 	asmjit::CBNode *cursorAfter = cc.getCursor();
 	cc.setCursor(cursorBefore);
 
@@ -434,10 +463,33 @@ void JitCompiler::EmitNativeCall(VMNativeFunction *target)
 				call->setArg(slot, tmp2);
 				break;
 
+			// The register is written to its VM frame slot and the callee gets the slot's address.
+			// LoadInOuts picks up whatever the callee stored there.
 			case REGT_INT | REGT_ADDROF:
+				CheckVMFrame();
+				tmp = newTempIntPtr();
+				cc.lea(tmp, x86::ptr(vmframe, offsetD + (int)(bc * sizeof(int32_t))));
+				cc.mov(x86::dword_ptr(tmp), regD[bc]);
+				call->setArg(slot, tmp);
+				break;
 			case REGT_POINTER | REGT_ADDROF:
+				CheckVMFrame();
+				tmp = newTempIntPtr();
+				cc.lea(tmp, x86::ptr(vmframe, offsetA + (int)(bc * sizeof(void*))));
+				cc.mov(x86::ptr(tmp), regA[bc]);
+				call->setArg(slot, tmp);
+				break;
 			case REGT_FLOAT | REGT_ADDROF:
-				I_Error("REGT_ADDROF not implemented for native direct calls\n");
+				CheckVMFrame();
+				tmp = newTempIntPtr();
+				cc.lea(tmp, x86::ptr(vmframe, offsetF + (int)(bc * sizeof(double))));
+				// When passing the address to a float we don't know if the receiving function will treat it as float, vec2 or vec3.
+				for (int j = 0; j < 3; j++)
+				{
+					if ((unsigned int)(bc + j) < regF.Size())
+						cc.movsd(x86::qword_ptr(tmp, j * sizeof(double)), regF[bc + j]);
+				}
+				call->setArg(slot, tmp);
 				break;
 
 			default:
@@ -520,6 +572,8 @@ void JitCompiler::EmitNativeCall(VMNativeFunction *target)
 
 	cc.setCursor(cursorAfter);
 
+	LoadInOuts();
+
 	if (startret == 1 && numret > 0)
 	{
 		int type = retval[0].b;
@@ -61,6 +61,8 @@ private:
 	void EmitPopFrame();
 
 	void EmitNativeCall(VMNativeFunction *target);
+	void EmitDirectNativeCall(const asmjit::Operand_ &callee, const char *comment);
+	void EmitVirtualCall();
 	void EmitVMCall(asmjit::X86Gp ptr, VMFunction *target);
 	void EmitVtbl(const VMOP *op);
 
@@ -118,6 +118,20 @@ public:
 
 void ClearGlobalVMStack();
 
+// Per-function script profiling
+struct FScriptProfileInfo
+{
+	const char *Name;
+	int Calls;
+	double Total;	// in ms, including called script functions
+	double Self;	// in ms, excluding called script functions
+};
+
+bool VMProfile_IsActive();
+void VMProfile_Enable(bool on);
+void VMProfile_Reset();
+void VMProfile_GetSorted(TArray<FScriptProfileInfo> &list);
+
 struct VMReturn
 {
 	void *Location;
@@ -826,6 +840,21 @@ unsigned GetVirtualIndex(PClass *cls, const char *funcname);
 
 #define IFVIRTUAL(cls, funcname) IFVIRTUALPTR(this, cls, funcname)
 
+// Like IFVIRTUALPTR but only true if the receiver's class replaced the base class's
+// function, so that the caller can skip the VM call and run the native default directly.
+// The base function is looked up on each call so that it stays valid when scripts get recompiled.
+#define IFOVERRIDENVIRTUALPTR(self, cls, funcname) \
+	static unsigned VIndex = ~0u; \
+	if (VIndex == ~0u) { \
+		VIndex = GetVirtualIndex(RUNTIME_CLASS(cls), #funcname); \
+		assert(VIndex != ~0u); \
+	} \
+	auto clss = self->GetClass(); \
+	VMFunction *func = clss->Virtuals.Size() > VIndex? clss->Virtuals[VIndex] : nullptr;  \
+	if (func != nullptr && func != RUNTIME_CLASS(cls)->Virtuals[VIndex])
+
+#define IFOVERRIDENVIRTUAL(cls, funcname) IFOVERRIDENVIRTUALPTR(this, cls, funcname)
+
 #define IFVIRTUALPTRNAME(self, cls, funcname) \
 	static unsigned VIndex = ~0u; \
 	if (VIndex == ~0u) { \
@@ -33,9 +33,11 @@
 */
 
 #include <new>
+#include <algorithm>
 #include "dobject.h"
 #include "v_text.h"
 #include "stats.h"
+#include "zoneprofiler.h"
 #include "c_dispatch.h"
 
 #include "vmintern.h"
@@ -294,17 +296,19 @@ void VMScriptFunction::JitCompile()
 {
 	if(!(VarFlags & VARF_Abstract))
 	{
+		// While profiling, ScriptCall must keep pointing to the profiler.
+		auto &entry = ProfiledCall != nullptr ? ProfiledCall : ScriptCall;
 	#ifdef HAVE_VM_JIT
 		if (vm_jit && CanJit(this))
 		{
-			ScriptCall = ::JitCompile(this);
-			if (!ScriptCall)
-				ScriptCall = VMExec;
+			entry = ::JitCompile(this);
+			if (!entry)
+				entry = VMExec;
 		}
 		else
 	#endif // HAVE_VM_JIT
 		{
-			ScriptCall = VMExec;
+			entry = VMExec;
 		}
 	}
 }
@@ -591,6 +595,7 @@ int VMCall(VMFunction *func, VMValue *params, int numparams, VMReturn *results,
 			}
 			else
 			{
+				FProfileZone zone(func->PrintableName);
 				VMCycles[0].Clock();
 
 				auto sfunc = static_cast<VMScriptFunction *>(func);
@@ -769,6 +774,107 @@ ADD_STAT(VM)
 	return FStringf("VM time in last 10 tics: %f ms, %d calls, peak = %f ms", added, addedc, peak);
 }
 
+//-----------------------------------------------------------------------------
+//
+// Script function profiling
+//
+// While active, the entry point of every script function is replaced with
+// ProfileScriptCall. Both the interpreter and the JIT call script functions
+// through ScriptCall, so this catches every script-to-script call without
+// costing anything while profiling is off.
+//
+//-----------------------------------------------------------------------------
+
+static bool ScriptProfiling;
+static double *ScriptProfileChildTime;
+
+bool VMProfile_IsActive()
+{
+	return ScriptProfiling;
+}
+
+int VMScriptFunction::ProfileScriptCall(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret)
+{
+	auto sfunc = static_cast<VMScriptFunction *>(func);
+
+	// Compile the function here so that FirstScriptCall won't recurse into the profiler.
+	if (sfunc->ProfiledCall == &VMScriptFunction::FirstScriptCall && !(sfunc->VarFlags & VARF_Abstract))
+	{
+		sfunc->JitCompile();
+	}
+
+	struct ChildTimeGuard
+	{
+		double *parent = ScriptProfileChildTime;
+		double childtime = 0;
+		ChildTimeGuard() { ScriptProfileChildTime = &childtime; }
+		~ChildTimeGuard() { ScriptProfileChildTime = parent; }
+	} guard;
+
+	cycle_t timer;
+	timer.ResetAndClock();
+	int numret1 = sfunc->ProfiledCall(func, params, numparams, ret, numret);
+	timer.Unclock();
+
+	double time = timer.TimeMS();
+	sfunc->ProfileCalls++;
+	sfunc->ProfileTotal += time;
+	sfunc->ProfileSelf += time - guard.childtime;
+	if (guard.parent != nullptr) *guard.parent += time;
+	return numret1;
+}
+
+void VMProfile_Enable(bool on)
+{
+	ScriptProfiling = on;
+
+	for (auto func : VMFunction::AllFunctions)
+	{
+		if (func->VarFlags & VARF_Native) continue;
+		auto sfunc = static_cast<VMScriptFunction *>(func);
+		if (on && sfunc->ProfiledCall == nullptr)
+		{
+			sfunc->ProfiledCall = sfunc->ScriptCall;
+			sfunc->ScriptCall = &VMScriptFunction::ProfileScriptCall;
+		}
+		else if (!on && sfunc->ProfiledCall != nullptr)
+		{
+			sfunc->ScriptCall = sfunc->ProfiledCall;
+			sfunc->ProfiledCall = nullptr;
+		}
+	}
+}
+
+void VMProfile_Reset()
+{
+	for (auto func : VMFunction::AllFunctions)
+	{
+		if (func->VarFlags & VARF_Native) continue;
+		auto sfunc = static_cast<VMScriptFunction *>(func);
+		sfunc->ProfileCalls = 0;
+		sfunc->ProfileTotal = sfunc->ProfileSelf = 0;
+	}
+}
+
+// Returns all functions that have been called, sorted by self time.
+void VMProfile_GetSorted(TArray<FScriptProfileInfo> &list)
+{
+	list.Clear();
+	for (auto func : VMFunction::AllFunctions)
+	{
+		if (func->VarFlags & VARF_Native) continue;
+		auto sfunc = static_cast<VMScriptFunction *>(func);
+		if (sfunc->ProfileCalls > 0)
+		{
+			list.Push({ sfunc->PrintableName, sfunc->ProfileCalls, sfunc->ProfileTotal, sfunc->ProfileSelf });
+		}
+	}
+	std::sort(list.begin(), list.end(), [](const FScriptProfileInfo &left, const FScriptProfileInfo &right)
+	{
+		return right.Self < left.Self;
+	});
+}
+
 //-----------------------------------------------------------------------------
 //
 //
@@ -476,6 +476,12 @@ public:
 
 	bool blockJit = false; // function triggers Jit bugs, block compilation until bugs are fixed
 
+	// Only used while script profiling is active. ProfiledCall holds the real entry point.
+	int(*ProfiledCall)(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret) = nullptr;
+	int ProfileCalls = 0;
+	double ProfileTotal = 0;	// in ms, including called script functions
+	double ProfileSelf = 0;		// in ms, excluding called script functions
+
 	void InitExtra(void *addr);
 	void DestroyExtra(void *addr);
 	int AllocExtraStack(PType *type);
@@ -483,6 +489,8 @@ public:
 
 private:
 	static int FirstScriptCall(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret);
+	static int ProfileScriptCall(VMFunction *func, VMValue *params, int numparams, VMReturn *ret, int numret);
 	void JitCompile();
 	friend class FFunctionBuildList;
+	friend void VMProfile_Enable(bool on);
 };
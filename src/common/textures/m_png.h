@@ -35,6 +35,7 @@
 
 #include <stdio.h>
 #include "zstring.h"
+#include "tarray.h"
 #include "files.h"
 #include "palentry.h"
 
@@ -69,6 +70,24 @@ bool M_FinishPNG (FileWriter *file);
 
 bool M_SaveBitmap(const uint8_t *from, ESSType color_type, int width, int height, int pitch, FileWriter *file);
 
+// An image that has been captured but not encoded yet, so that the PNG
+// can be created later, e.g. on a different thread.
+struct FPNGImage
+{
+	TArray<uint8_t> Pixels;
+	PalEntry Palette[256];
+	ESSType ColorType = SS_PAL;
+	int Width = 0;
+	int Height = 0;
+	int Pitch = 0;
+	float Gamma = 1.f;
+
+	bool Write(FileWriter *file) const
+	{
+		return M_CreatePNG(file, Pixels.Data(), ColorType == SS_PAL ? Palette : nullptr, ColorType, Width, Height, Pitch, Gamma);
+	}
+};
+
 // PNG Reading --------------------------------------------------------------
 
 struct PNGHandle
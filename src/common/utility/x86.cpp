@@ -49,6 +49,11 @@ FString DumpCPUInfo(const CPUInfo *cpu, bool brief)
 {
 	return FString();
 }
+
+bool CanUseAVX2(const CPUInfo *cpu)
+{
+	return false;
+}
 #else
 
 #ifdef _MSC_VER
@@ -161,6 +166,32 @@ void CheckCPUID(CPUInfo *cpu)
 	}
 }
 
+//==========================================================================
+//
+// CanUseAVX2
+//
+// The CPUID bits only say that the processor knows the instructions.
+// The OS must also save the YMM registers on a context switch, which
+// XGETBV reports.
+//
+//==========================================================================
+
+bool CanUseAVX2(const CPUInfo *cpu)
+{
+	if (!cpu->bAVX || !cpu->bAVX2 || !cpu->bOSXSAVE)
+	{
+		return false;
+	}
+#ifdef _MSC_VER
+	uint64_t xcr0 = _xgetbv(0);
+#else
+	uint32_t eax, edx;
+	__asm__ __volatile__("xgetbv" : "=a" (eax), "=d" (edx) : "c" (0));
+	uint64_t xcr0 = ((uint64_t)edx << 32) | eax;
+#endif
+	return (xcr0 & 6) == 6;
+}
+
 FString DumpCPUInfo(const CPUInfo *cpu, bool brief)
 {
 	char cpustring[4*4*3+1];
@@ -230,6 +230,7 @@ extern CPUInfo CPU;
 
 void CheckCPUID (CPUInfo *cpu);
 FString DumpCPUInfo (const CPUInfo *cpu, bool brief = false);
+bool CanUseAVX2 (const CPUInfo *cpu);
 
 #endif
 
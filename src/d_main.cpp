@@ -54,6 +54,7 @@
 #include "wipe.h"
 #include "m_argv.h"
 #include "m_misc.h"
+#include "i_specialpaths.h"
 #include "menu.h"
 #include "doommenu.h"
 #include "c_console.h"
@@ -118,6 +119,7 @@
 #include "screenjob.h"
 #include "startscreen.h"
 #include "shiftstate.h"
+#include "p_benchmark.h"
 
 #ifdef __unix__
 #include "i_system.h"  // for SHARE_DIR
@@ -297,6 +299,8 @@ CVAR(Bool, disableautoload, false, CVAR_ARCHIVE | CVAR_NOINITCALL | CVAR_GLOBALC
 CVAR(Bool, autoloadbrightmaps, false, CVAR_ARCHIVE | CVAR_NOINITCALL | CVAR_GLOBALCONFIG)
 CVAR(Bool, autoloadlights, false, CVAR_ARCHIVE | CVAR_NOINITCALL | CVAR_GLOBALCONFIG)
 CVAR(Bool, autoloadwidescreen, true, CVAR_ARCHIVE | CVAR_NOINITCALL | CVAR_GLOBALCONFIG)
+CVAR(Bool, fs_indexcache, true, CVAR_ARCHIVE | CVAR_NOINITCALL | CVAR_GLOBALCONFIG)	// cache the directories of zips and 7zs between sessions
+CVAR(Bool, fs_mapfiles, false, CVAR_ARCHIVE | CVAR_NOINITCALL | CVAR_GLOBALCONFIG)	// memory map loaded files. Off by default because truncating a mapped file while the engine runs crashes it on POSIX systems.
 CVAR(Bool, r_debug_disable_vis_filter, false, 0)
 CVAR(Int, vid_showpalette, 0, 0)
 
@@ -315,6 +319,7 @@ bool hud_toggled = false;
 bool wantToRestart;
 bool DrawFSHUD;				// [RH] Draw fullscreen HUD?
 bool devparm;				// started game with -devparm
+bool novideo;				// started with -novideo, there is no display to draw to
 const char *D_DrawIcon;	// [RH] Patch name of icon to draw on next refresh
 int NoWipe;				// [RH] Allow wipe? (Needs to be set each time)
 bool singletics = false;	// debug flag to cancel adaptiveness
@@ -1210,6 +1215,11 @@ void D_DoomLoop ()
 
 	vid_cursor->Callback();
 
+	if (benchplaysim)
+	{
+		P_RunPlaysimBenchmark();	// only left by exiting the program
+	}
+
 	for (;;)
 	{
 		try
@@ -1951,6 +1961,8 @@ void GetReserved(LumpFilterInfo& lfi)
 	"materials/", "models/", "fonts/", "brightmaps/" };
 	lfi.requiredPrefixes = { "mapinfo", "zmapinfo", "umapinfo", "gameinfo", "sndinfo", "sndseq", "sbarinfo", "menudef", "gldefs", "animdefs", "decorate", "zscript", "iwadinfo", "complvl", "terrain", "maps/" };
 	lfi.blockednames = { "*.bat", "*.exe", "__macosx/*", "*/__macosx/*" };
+	if (fs_indexcache) lfi.indexCachePath = M_GetCachePath(true).GetChars();
+	lfi.mapFiles = fs_mapfiles && !Args->CheckParm("-nommap");
 }
 
 static FString CheckGameInfo(std::vector<std::string> & pwads)
@@ -3200,7 +3212,7 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 
 	int max_progress = TexMan.GuesstimateNumTextures();
 	int per_shader_progress = 0;//screen->GetShaderCount()? (max_progress / 10 / screen->GetShaderCount()) : 0;
-	bool nostartscreen = batchrun || restart || Args->CheckParm("-join") || Args->CheckParm("-host") || Args->CheckParm("-norun");
+	bool nostartscreen = batchrun || restart || novideo || Args->CheckParm("-join") || Args->CheckParm("-host") || Args->CheckParm("-norun");
 
 	if (GameStartupInfo.Type == FStartupInfo::DefaultStartup)
 	{
@@ -3537,6 +3549,10 @@ static int D_InitGame(const FIWADInfo* iwad_info, std::vector<std::string>& allw
 			{
 				G_TimeDemo(v);
 			}
+			else if ((v = Args->CheckValue("-benchplaysim")))
+			{
+				G_BenchPlaysim(v);
+			}
 			else
 			{
 				if (gameaction != ga_loadgame && gameaction != ga_loadgamehidecon)
@@ -3687,6 +3703,18 @@ static int D_DoomMain_Internal (void)
 		Printf("\n");
 	}
 
+	// The playsim benchmark must not depend on any audio or video hardware.
+	if (Args->CheckParm("-benchplaysim"))
+	{
+		Args->AppendArg("-nosound");
+		if (!Args->CheckParm("-novideo")) Args->AppendArg("-novideo");
+	}
+
+	// Without a display nothing can be presented, so the main loop skips drawing altogether.
+	// Only the offscreen software renderer (see swbench) can be used.
+	novideo = !!Args->CheckParm("-novideo");
+	if (novideo) nodrawers = true;
+
 	Printf("%s version %s\n", GAMENAME, GetVersionString());
 
 	extern void D_ConfirmSendStats();
@@ -3753,7 +3781,7 @@ static int D_DoomMain_Internal (void)
 		if (ret != 0) return ret;
 
 		D_DoAnonStats();
-		I_UpdateWindowTitle();
+		if (!novideo) I_UpdateWindowTitle();
 		D_DoomLoop ();		// this only returns if a 'restart' CCMD is given.
 		// 
 		// Clean up after a restart
@@ -3825,6 +3853,8 @@ int GameMain()
 
 void D_Cleanup()
 {
+	G_FinishAsyncSave(true);
+
 	if (demorecording)
 	{
 		G_CheckDemoStatus();
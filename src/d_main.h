@@ -159,9 +159,12 @@ EXTERN_CVAR(Int, vid_rendermode)
 constexpr int vid_rendermode = 4;
 #endif
 
+extern bool novideo;
+
+// Without a video backend there is nothing the hardware renderer could use, so the software renderer takes over.
 inline bool V_IsHardwareRenderer()
 {
-	return vid_rendermode == 4;
+	return vid_rendermode == 4 && !novideo;
 }
 
 inline bool V_IsTrueColor()
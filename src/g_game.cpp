@@ -27,6 +27,8 @@
 #include <stdio.h>
 #include <stddef.h>
 #include <memory>
+#include <thread>
+#include <atomic>
 
 #include "i_time.h"
 
@@ -91,6 +93,8 @@
 #include "screenjob.h"
 #include "i_interface.h"
 #include "fs_findfile.h"
+#include "p_benchmark.h"
+#include "g_rewind.h"
 
 
 static FRandom pr_dmspawn ("DMSpawn");
@@ -118,6 +122,8 @@ void STAT_Serialize(FSerializer &file);
 
 CVARD_NAMED(Int, gameskill, skill, 2, CVAR_SERVERINFO|CVAR_LATCH, "sets the skill for the next newly started game")
 CVAR(Bool, save_formatted, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// use formatted JSON for saves (more readable but a larger files and a bit slower.
+CVAR(Bool, save_binary, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// use the compact binary format for saves (much faster to write and read, but cannot be opened by older versions).
+CVAR(Bool, save_async, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// compress and write saves on a background thread.
 CVAR (Int, deathmatch, 0, CVAR_SERVERINFO|CVAR_LATCH);
 CVAR (Bool, chasedemo, false, 0);
 CVAR (Bool, storesavepic, true, CVAR_ARCHIVE|CVAR_GLOBALCONFIG)
@@ -1142,6 +1148,8 @@ void G_Ticker ()
 	int i;
 	gamestate_t	oldgamestate;
 
+	G_FinishAsyncSave(false);
+
 	// do player reborns if needed
 	for (i = 0; i < MAXPLAYERS; i++)
 	{
@@ -1199,6 +1207,9 @@ void G_Ticker ()
 			G_DoAutoSave ();
 			gameaction = ga_nothing;
 			break;
+		case ga_rewind:
+			G_DoRewind ();
+			break;
 		case ga_loadgameplaydemo:
 			G_DoLoadGame ();
 			// fallthrough
@@ -1326,6 +1337,7 @@ void G_Ticker ()
 	case GS_LEVEL:
 		P_Ticker ();
 		primaryLevel->automap->Ticker ();
+		G_RewindTicker ();
 		break;
 
 	case GS_TITLELEVEL:
@@ -2024,6 +2036,7 @@ void FinishLoadingCVars();
 
 void G_DoLoadGame ()
 {
+	G_FinishAsyncSave(true);
 	SetupLoadingCVars();
 	bool hidecon;
 
@@ -2034,6 +2047,17 @@ void G_DoLoadGame ()
 	hidecon = gameaction == ga_loadgamehidecon;
 	gameaction = ga_nothing;
 
+	// The last savegame may still be around in memory.
+	if (G_LoadSaveState(savename))
+	{
+		if (hidecon && gamestate == GS_FULLCONSOLE)
+		{
+			gamestate = GS_HIDECONSOLE;
+		}
+		BackupSaveName = savename;
+		return;
+	}
+
 	std::unique_ptr<FResourceFile> resfile(FResourceFile::OpenResourceFile(savename.GetChars(), true));
 	if (resfile == nullptr)
 	{
@@ -2132,7 +2156,22 @@ void G_DoLoadGame ()
 		return;
 	}
 
+	G_ReadSnapshots(resfile.get());
+	resfile.reset(nullptr);	// we no longer need the resource file below this point
+	G_RestoreGameState(arc, map.GetChars());
+	BackupSaveName = savename;
+}
 
+//==========================================================================
+//
+// Reads the global part of a savegame and restores the level from its
+// snapshot, which must already have been set up by the caller.
+// This is shared by G_DoLoadGame and the in-memory save states.
+//
+//==========================================================================
+
+void G_RestoreGameState(FSerializer &arc, const char *map)
+{
 	// Read intermission data for hubs
 	G_SerializeHub(arc);
 
@@ -2162,13 +2201,11 @@ void G_DoLoadGame ()
 	// dearchive all the modifications
 	level.time = Scale(time[1], TICRATE, time[0]);
 
-	G_ReadSnapshots(resfile.get());
-	resfile.reset(nullptr);	// we no longer need the resource file below this point
 	G_ReadVisited(arc);
 
 	// load a base level
 	bool demoplaybacksave = demoplayback;
-	G_InitNew(map.GetChars(), false);
+	G_InitNew(map, false);
 	FinishLoadingCVars();
 	demoplayback = demoplaybacksave;
 	savegamerestore = false;
@@ -2184,8 +2221,6 @@ void G_DoLoadGame ()
 	if (level.info != nullptr)
 		level.info->Snapshot.Clean();
 
-	BackupSaveName = savename;
-
 	// At this point, the GC threshold is likely a lot higher than the
 	// amount of memory in use, so bring it down now by starting a
 	// collection.
@@ -2361,6 +2396,170 @@ static void PutSavePic (FileWriter *file, int width, int height)
 	}
 }
 
+//==========================================================================
+//
+// Asynchronous savegames
+//
+// The game state is serialized on the main thread, but compressing it,
+// encoding the savepic and writing the file is left to a worker thread
+// so that the game does not stall while saving.
+//
+//==========================================================================
+
+struct FAsyncSave
+{
+	FString Filename;
+	FString Description;
+	bool OkForQuicksave;
+	bool ForceQuicksave;
+
+	FPNGImage SavePic;
+	FString Software;
+	FString MapName;
+
+	TArray<FCompressedBuffer> Content;	// owned by this, unlike in the synchronous path
+	TArray<FString> Filenames;
+	TArray<bool> Compress;				// still needs to be compressed
+
+	std::thread Thread;
+	std::atomic<bool> Done = false;
+	bool Succeeded = false;
+};
+
+static FAsyncSave *AsyncSave;
+
+static bool G_WriteSaveFile(const char *filename, TArray<FCompressedBuffer> &content, TArray<FString> &filenames)
+{
+	for (unsigned i = 0; i < content.Size(); i++)
+		content[i].filename = filenames[i].GetChars();
+
+	if (WriteZip(filename, content.Data(), content.Size()))
+	{
+		// Check whether the file is ok by trying to open it.
+		FResourceFile *test = FResourceFile::OpenResourceFile(filename, true);
+		if (test != nullptr)
+		{
+			delete test;
+			return true;
+		}
+	}
+	return false;
+}
+
+static void G_SaveGameDone(bool succeeded, const FString &filename, const char *description, bool okForQuicksave, bool forceQuicksave)
+{
+	if (succeeded)
+	{
+		savegameManager.NotifyNewSave(filename, description, okForQuicksave, forceQuicksave);
+		BackupSaveName = filename;
+		G_SaveStateWritten(filename, true);
+
+		if (longsavemessages) Printf("%s (%s)\n", GStrings.GetString("GGSAVED"), filename.GetChars());
+		else Printf("%s\n", GStrings.GetString("GGSAVED"));
+	}
+	else
+	{
+		G_SaveStateWritten(filename, false);
+		Printf(PRINT_HIGH, "%s\n", GStrings.GetString("TXT_SAVEFAILED"));
+	}
+}
+
+static void G_AsyncSaveThread(FAsyncSave *save)
+{
+	BufferWriter savepic;
+	if (save->SavePic.Width > 0) save->SavePic.Write(&savepic);
+	else M_CreateDummyPNG(&savepic);
+	M_AppendPNGText(&savepic, "Software", save->Software.GetChars());
+	M_AppendPNGText(&savepic, "Title", save->Description.GetChars());
+	M_AppendPNGText(&savepic, "Current Map", save->MapName.GetChars());
+	M_FinishPNG(&savepic);
+
+	for (unsigned i = 0; i < save->Content.Size(); i++)
+	{
+		if (save->Compress[i])
+		{
+			auto &buff = save->Content[i];
+			auto compressed = CompressSerializerData(buff.mBuffer, buff.mSize);
+			buff.Clean();
+			buff = compressed;
+		}
+	}
+
+	auto picdata = savepic.GetBuffer();
+	FCompressedBuffer bufpng = { picdata->size(), picdata->size(), FileSys::METHOD_STORED, static_cast<unsigned int>(crc32(0, &(*picdata)[0], picdata->size())), (char*)&(*picdata)[0] };
+	save->Content.Insert(0, bufpng);
+	save->Filenames.Insert(0, "savepic.png");
+
+	save->Succeeded = G_WriteSaveFile(save->Filename.GetChars(), save->Content, save->Filenames);
+
+	// The picture is owned by the BufferWriter.
+	save->Content[0].mBuffer = nullptr;
+	save->Done = true;
+}
+
+//==========================================================================
+//
+// Reports the result of a finished background save.
+// If 'wait' is set, this blocks until the save is done.
+//
+//==========================================================================
+
+void G_FinishAsyncSave(bool wait)
+{
+	if (AsyncSave == nullptr || (!wait && !AsyncSave->Done))
+	{
+		return;
+	}
+
+	auto save = AsyncSave;
+	AsyncSave = nullptr;
+	save->Thread.join();
+	G_SaveGameDone(save->Succeeded, save->Filename, save->Description.GetChars(), save->OkForQuicksave, save->ForceQuicksave);
+	for (auto &buff : save->Content) buff.Clean();
+	delete save;
+}
+
+//==========================================================================
+//
+// Writes everything a savegame needs besides the level snapshots.
+//
+//==========================================================================
+
+void G_WriteGameGlobals(FSerializer &arc)
+{
+	// Intermission stats for hubs
+	G_SerializeHub(arc);
+	C_SerializeCVars(arc, "servercvars", CVAR_SERVERINFO);
+
+	if (level.time != 0 || level.maptime != 0)
+	{
+		int tic = TICRATE;
+		arc("ticrate", tic);
+		arc("leveltime", level.time);
+	}
+
+	arc("globalfreeze", globalfreeze)
+		("startpos", startpos)
+		("laststartpos", laststartpos);
+
+	STAT_Serialize(arc);
+	FRandom::StaticWriteRNGState(arc);
+	P_WriteACSDefereds(arc);
+	P_WriteACSVars(arc);
+	G_WriteVisited(arc);
+
+	if (NextSkill != -1)
+	{
+		arc("nextskill", NextSkill);
+	}
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
 void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, const char *description)
 {
 	TArray<FCompressedBuffer> savegame_content;
@@ -2375,18 +2574,22 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 		return;
 	}
 
+	// Only one save may be written at a time.
+	G_FinishAsyncSave(true);
+	bool async = save_async;
+
 	if (demoplayback)
 	{
 		filename = G_BuildSaveName ("demosave");
 	}
 
-	if (cl_waitforsave)
+	if (cl_waitforsave && !async)
 		I_FreezeTime(true);
 
 	insave = true;
 	try
 	{
-		level.SnapshotLevel();
+		level.SnapshotLevel(!async);
 	}
 	catch(CRecoverableError &err)
 	{
@@ -2396,14 +2599,14 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 		Printf(PRINT_HIGH, "Save failed\n");
 		Printf(PRINT_HIGH, "%s\n", err.GetMessage());
 		// The time freeze must be reset if the save fails.
-		if (cl_waitforsave)
+		if (cl_waitforsave && !async)
 			I_FreezeTime(false);
 		return;
 	}
 	catch (...)
 	{
 		insave = false;
-		if (cl_waitforsave)
+		if (cl_waitforsave && !async)
 			I_FreezeTime(false);
 		throw;
 	}
@@ -2413,16 +2616,36 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 	FSerializer savegameglobals;	// and this for non-level related info that must be saved.
 
 	savegameinfo.OpenWriter(true);
-	savegameglobals.OpenWriter(save_formatted);
+	savegameglobals.OpenWriter(save_formatted, save_binary);
 
 	SaveVersion = SAVEVER;
-	PutSavePic(&savepic, SAVEPICWIDTH, SAVEPICHEIGHT);
 	mysnprintf(buf, countof(buf), GAMENAME " %s", GetVersionString());
-	// put some basic info into the PNG so that this isn't lost when the image gets extracted.
-	M_AppendPNGText(&savepic, "Software", buf);
-	M_AppendPNGText(&savepic, "Title", description);
-	M_AppendPNGText(&savepic, "Current Map", primaryLevel->MapName.GetChars());
-	M_FinishPNG(&savepic);
+	FAsyncSave *save = nullptr;
+	if (async)
+	{
+		save = new FAsyncSave;
+		save->Filename = filename;
+		save->Description = description;
+		save->OkForQuicksave = okForQuicksave;
+		save->ForceQuicksave = forceQuicksave;
+		save->Software = buf;
+		save->MapName = primaryLevel->MapName;
+		if (SAVEPICWIDTH > 0 && SAVEPICHEIGHT > 0 && storesavepic)
+		{
+			SavePicCapture = &save->SavePic;
+			PutSavePic(&savepic, SAVEPICWIDTH, SAVEPICHEIGHT);
+			SavePicCapture = nullptr;
+		}
+	}
+	else
+	{
+		PutSavePic(&savepic, SAVEPICWIDTH, SAVEPICHEIGHT);
+		// put some basic info into the PNG so that this isn't lost when the image gets extracted.
+		M_AppendPNGText(&savepic, "Software", buf);
+		M_AppendPNGText(&savepic, "Title", description);
+		M_AppendPNGText(&savepic, "Current Map", primaryLevel->MapName.GetChars());
+		M_FinishPNG(&savepic);
+	}
 
 	int ver = SAVEVER;
 	savegameinfo.AddString("Software", buf)
@@ -2435,31 +2658,42 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 	PutSaveWads (savegameinfo);
 	PutSaveComment (savegameinfo);
 
-	// Intermission stats for hubs
-	G_SerializeHub(savegameglobals);
-	C_SerializeCVars(savegameglobals, "servercvars", CVAR_SERVERINFO);
+	G_WriteGameGlobals(savegameglobals);
 
-	if (level.time != 0 || level.maptime != 0)
+	if (async)
 	{
-		int tic = TICRATE;
-		savegameglobals("ticrate", tic);
-		savegameglobals("leveltime", level.time);
-	}
-
-	savegameglobals("globalfreeze", globalfreeze)
-					("startpos", startpos)
-					("laststartpos", laststartpos);
-
-	STAT_Serialize(savegameglobals);
-	FRandom::StaticWriteRNGState(savegameglobals);
-	P_WriteACSDefereds(savegameglobals);
-	P_WriteACSVars(savegameglobals);
-	G_WriteVisited(savegameglobals);
+		save->Content.Push(savegameinfo.GetStoredOutput());
+		save->Filenames.Push("info.json");
+		save->Content.Push(savegameglobals.GetStoredOutput());
+		save->Filenames.Push("globals.json");
+		G_WriteSnapshots (save->Filenames, save->Content);
+		G_KeepSaveState(filename);
+		save->Compress.Resize(save->Content.Size());
 
+		for (unsigned i = 0; i < save->Content.Size(); i++)
+		{
+			auto &buff = save->Content[i];
+			if (i < 2 || buff.mBuffer == level.info->Snapshot.mBuffer)
+			{
+				// These were created for this save only, so the worker can take them over.
+				save->Compress[i] = true;
+			}
+			else
+			{
+				// Snapshots of other hub levels stay with their level, so the worker needs its own copy.
+				char *copy = new char[buff.mCompressedSize];
+				memcpy(copy, buff.mBuffer, buff.mCompressedSize);
+				buff.mBuffer = copy;
+				save->Compress[i] = false;
+			}
+		}
+		level.info->Snapshot.mBuffer = nullptr;
+		level.info->Snapshot.Clean();
 
-	if (NextSkill != -1)
-	{
-		savegameglobals("nextskill", NextSkill);
+		save->Thread = std::thread(G_AsyncSaveThread, save);
+		AsyncSave = save;
+		insave = false;
+		return;
 	}
 
 	auto picdata = savepic.GetBuffer();
@@ -2472,36 +2706,10 @@ void G_DoSaveGame (bool okForQuicksave, bool forceQuicksave, FString filename, c
 	savegame_content.Push(savegameglobals.GetCompressedOutput());
 	savegame_filenames.Push("globals.json");
 	G_WriteSnapshots (savegame_filenames, savegame_content);
-	
-	for (unsigned i = 0; i < savegame_content.Size(); i++)
-		savegame_content[i].filename = savegame_filenames[i].GetChars();
-
-	bool succeeded = false;
-
-	if (WriteZip(filename.GetChars(), savegame_content.Data(), savegame_content.Size()))
-	{
-		// Check whether the file is ok by trying to open it.
-		FResourceFile *test = FResourceFile::OpenResourceFile(filename.GetChars(), true);
-		if (test != nullptr)
-		{
-			delete test;
-			succeeded = true;
-		}
-	}
-
-	if (succeeded)
-	{
-		savegameManager.NotifyNewSave(filename, description, okForQuicksave, forceQuicksave);
-		BackupSaveName = filename;
-
-		if (longsavemessages) Printf("%s (%s)\n", GStrings.GetString("GGSAVED"), filename.GetChars());
-		else Printf("%s\n", GStrings.GetString("GGSAVED"));
-	}
-	else
-	{
-		Printf(PRINT_HIGH, "%s\n", GStrings.GetString("TXT_SAVEFAILED"));
-	}
+	G_KeepSaveState(filename);
 
+	bool succeeded = G_WriteSaveFile(filename.GetChars(), savegame_content, savegame_filenames);
+	G_SaveGameDone(succeeded, filename, description, okForQuicksave, forceQuicksave);
 
 	// delete the JSON buffers we created just above. Everything else will
 	// either still be needed or taken care of automatically.
@@ -2727,6 +2935,24 @@ void G_DeferedPlayDemo (const char *name)
 	gameaction = (gameaction == ga_loadgame) ? ga_loadgameplaydemo : ga_playdemo;
 }
 
+//
+// G_BenchPlaysim
+//
+// Like G_TimeDemo, but nothing gets drawn and the main loop is replaced
+// with P_RunPlaysimBenchmark, which records per-tic playsim timings.
+//
+void G_BenchPlaysim (const char* name)
+{
+	nodrawers = true;
+	noblit = true;
+	benchplaysim = true;
+	singledemo = true;
+	singletics = true;
+
+	defdemoname = name;
+	gameaction = (gameaction == ga_loadgame) ? ga_loadgameplaydemo : ga_playdemo;
+}
+
 UNSAFE_CCMD (playdemo)
 {
 	if (netgame)
@@ -2996,7 +3222,7 @@ void G_DoPlayDemo (void)
 //
 void G_TimeDemo (const char* name)
 {
-	nodrawers = !!Args->CheckParm ("-nodraw");
+	nodrawers = novideo || !!Args->CheckParm ("-nodraw");
 	noblit = !!Args->CheckParm ("-noblit");
 	timingdemo = true;
 	singletics = true;
@@ -3025,6 +3251,11 @@ bool G_CheckDemoStatus (void)
 
 	if (demoplayback)
 	{
+		if (benchplaysim)
+		{
+			P_FinishPlaysimBenchmark();	// does not return
+		}
+
 		extern int starttime;
 		int endtime = 0;
 
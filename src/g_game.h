@@ -62,9 +62,12 @@ void G_DeferedPlayDemo (const char* demo);
 void G_LoadGame (const char* name, bool hidecon=false);
 
 void G_DoLoadGame (void);
+void G_RestoreGameState (FSerializer &arc, const char *map);
 
 // Called by M_Responder.
 void G_SaveGame (const char *filename, const char *description);
+void G_FinishAsyncSave (bool wait);
+void G_WriteGameGlobals (FSerializer &arc);
 // Called by messagebox
 void G_DoQuickSave ();
 
@@ -75,6 +78,7 @@ void G_BeginRecording (const char *startmap);
 
 void G_PlayDemo (char* name);
 void G_TimeDemo (const char* name);
+void G_BenchPlaysim (const char* name);
 bool G_CheckDemoStatus (void);
 
 void G_Ticker (void);
@@ -99,6 +99,7 @@
 #include "fragglescript/t_script.h"
 
 #include "texturemanager.h"
+#include "g_rewind.h"
 
 void STAT_StartNewGame(const char *lev);
 void STAT_ChangeLevel(const char *newl, FLevelLocals *Level);
@@ -1339,6 +1340,9 @@ void G_DoLoadLevel(const FString &nextmapname, int position, bool autosave, bool
 {
 	gamestate_t oldgs = gamestate;
 
+	// States from the previous level can not be rewound to.
+	G_ClearRewindStates();
+
 	// Here the new level needs to be allocated.
 	primaryLevel->DoLoadLevel(nextmapname, position, autosave, newGame);
 
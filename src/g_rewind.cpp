@@ -0,0 +1,461 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright 2024 GZDoom Maintainers and Contributors
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//		In-memory save states for rewinding and fast reloading of the
+//		last savegame. States are written with the binary serializer
+//		format and ring entries are stored as deltas against a keyframe.
+//
+//-----------------------------------------------------------------------------
+
+#include "g_rewind.h"
+#include "doomstat.h"
+#include "d_event.h"
+#include "g_game.h"
+#include "g_levellocals.h"
+#include "serializer_doom.h"
+#include "c_dispatch.h"
+#include "c_cvars.h"
+#include "printf.h"
+#include "version.h"
+#include "fs_findfile.h"
+
+void SetupLoadingCVars();
+extern level_info_t TheDefaultLevelInfo;
+
+CVAR(Int, rewind_interval, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)	// in tics, 0 disables the ring
+CVAR(Int, rewind_slots, 60, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CVAR(Int, rewind_keyframes, 10, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+CVAR(Bool, save_quickloadram, false, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+struct FSaveStateHub
+{
+	FString MapName;
+	FileSys::FCompressedBuffer Snapshot;
+};
+
+struct FSaveState
+{
+	FString MapName;
+	int Time;
+	bool Delta = false;				// Level is a delta against the closest older keyframe
+	TArray<char> Globals;
+	TArray<uint8_t> Level;
+};
+
+// The content of the last savegame, captured in binary form when it was written.
+struct FKeptSave
+{
+	FString Filename;
+	bool Written = false;			// FileSize and FileTime are valid
+	uint64_t FileSize = 0;
+	int64_t FileTime = 0;
+	FSaveState *State = nullptr;
+	TArray<FSaveStateHub> Hubs;
+
+	~FKeptSave()
+	{
+		delete State;
+		for (auto &hub : Hubs)
+		{
+			hub.Snapshot.Clean();
+		}
+	}
+};
+
+static TDeletingArray<FSaveState *> RewindStates;
+static FKeptSave *SaveState;
+static int RewindTarget = -1;
+static bool RestoringState;
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static FileSys::FCompressedBuffer CopyBuffer(const FileSys::FCompressedBuffer &buff)
+{
+	FileSys::FCompressedBuffer copy = buff;
+	if (buff.mBuffer != nullptr)
+	{
+		copy.mBuffer = new char[buff.mCompressedSize];
+		memcpy(copy.mBuffer, buff.mBuffer, buff.mCompressedSize);
+	}
+	return copy;
+}
+
+//==========================================================================
+//
+// G_CaptureState
+//
+// Writes the same data a savegame contains, but in binary form and
+// without compression.
+//
+//==========================================================================
+
+static FSaveState *G_CaptureState()
+{
+	if (primaryLevel->info == nullptr || !primaryLevel->info->isValid())
+	{
+		return nullptr;
+	}
+
+	auto state = new FSaveState;
+	state->MapName = primaryLevel->MapName;
+	state->Time = primaryLevel->time;
+
+	unsigned size;
+	const char *output;
+	SaveVersion = SAVEVER;
+	{
+		FDoomSerializer arc(primaryLevel);
+		arc.OpenWriter(false, true);
+		primaryLevel->Serialize(arc, false);
+		output = arc.GetOutput(&size);
+		state->Level.Resize(size);
+		memcpy(state->Level.Data(), output, size);
+	}
+	{
+		FSerializer arc;
+		arc.OpenWriter(false, true);
+		G_WriteGameGlobals(arc);
+		output = arc.GetOutput(&size);
+		state->Globals.Resize(size);
+		memcpy(state->Globals.Data(), output, size);
+	}
+	return state;
+}
+
+//==========================================================================
+//
+// G_RestoreState
+//
+// Restarts the level from a captured state. This is G_DoLoadGame
+// without the savegame file. The level data is taken over as the
+// level's snapshot. Hub snapshots are only passed for savegames,
+// rewinding never leaves the level.
+//
+//==========================================================================
+
+static bool G_RestoreState(const FString &mapname, FileSys::FCompressedBuffer *globals, FileSys::FCompressedBuffer &level, TArray<FSaveStateHub> *hubs)
+{
+	FSerializer arc;
+	if (!arc.OpenReader(globals))
+	{
+		level.Clean();
+		return false;
+	}
+
+	G_FinishAsyncSave(true);
+	SetupLoadingCVars();
+
+	if (hubs != nullptr || mapname.CompareNoCase(primaryLevel->MapName) != 0)
+	{
+		G_ClearSnapshots();
+	}
+	if (hubs != nullptr)
+	{
+		for (auto &hub : *hubs)
+		{
+			auto info = FindLevelInfo(hub.MapName.GetChars());
+			info->Snapshot = CopyBuffer(hub.Snapshot);
+		}
+	}
+
+	auto info = FindLevelInfo(mapname.GetChars());
+	info->Snapshot.Clean();
+	info->Snapshot = level;
+	level = { 0,0,0,0,0,nullptr };
+
+	G_RestoreGameState(arc, mapname.GetChars());
+	return true;
+}
+
+static bool G_RestoreState(FSaveState *state, const void *level, unsigned levelsize, TArray<FSaveStateHub> *hubs)
+{
+	// Both buffers hold uncompressed binary serializer output, so nothing needs to be inflated or parsed as JSON.
+	FileSys::FCompressedBuffer globals = { state->Globals.Size(), state->Globals.Size(), FileSys::METHOD_STORED, 0, state->Globals.Data(), nullptr };
+	FileSys::FCompressedBuffer snapshot = { levelsize, levelsize, FileSys::METHOD_STORED, 0, new char[levelsize], nullptr };
+	memcpy(snapshot.mBuffer, level, levelsize);
+	return G_RestoreState(state->MapName, &globals, snapshot, hubs);
+}
+
+//==========================================================================
+//
+// Returns the full level data of a ring entry.
+//
+//==========================================================================
+
+static bool G_GetStateLevel(unsigned index, TArray<char> &level)
+{
+	auto state = RewindStates[index];
+	if (!state->Delta)
+	{
+		level.Resize(state->Level.Size());
+		memcpy(level.Data(), state->Level.Data(), state->Level.Size());
+		return true;
+	}
+
+	unsigned key = index;
+	while (key > 0 && RewindStates[key]->Delta) key--;
+	auto &base = RewindStates[key]->Level;
+	return DecodeSerializerDelta((const char *)base.Data(), base.Size(), state->Level.Data(), state->Level.Size(), level);
+}
+
+//==========================================================================
+//
+// Removes the oldest ring entry. If it was a keyframe, the next entry
+// becomes one and the deltas that depended on it get rebuilt.
+//
+//==========================================================================
+
+static void G_DropOldestRewindState()
+{
+	if (RewindStates.Size() > 1 && !RewindStates[0]->Delta && RewindStates[1]->Delta)
+	{
+		TArray<char> key, full;
+		if (G_GetStateLevel(1, key))
+		{
+			for (unsigned i = 2; i < RewindStates.Size() && RewindStates[i]->Delta; i++)
+			{
+				if (G_GetStateLevel(i, full))
+				{
+					RewindStates[i]->Level = EncodeSerializerDelta(key.Data(), key.Size(), full.Data(), full.Size());
+				}
+			}
+			RewindStates[1]->Level.Resize(key.Size());
+			memcpy(RewindStates[1]->Level.Data(), key.Data(), key.Size());
+			RewindStates[1]->Delta = false;
+		}
+	}
+	delete RewindStates[0];
+	RewindStates.Delete(0);
+}
+
+//==========================================================================
+//
+// G_RewindTicker
+//
+// Adds a state to the ring every rewind_interval tics.
+//
+//==========================================================================
+
+void G_RewindTicker()
+{
+	if (rewind_interval <= 0 || netgame || gameaction != ga_nothing)
+	{
+		return;
+	}
+	if (RewindStates.Size() > 0 && primaryLevel->time - RewindStates.Last()->Time < rewind_interval)
+	{
+		return;
+	}
+
+	auto state = G_CaptureState();
+	if (state == nullptr) return;
+
+	int key = (int)RewindStates.Size() - 1;
+	while (key >= 0 && RewindStates[key]->Delta) key--;
+	if (key >= 0 && (int)RewindStates.Size() - key < rewind_keyframes)
+	{
+		auto &base = RewindStates[key]->Level;
+		auto delta = EncodeSerializerDelta((const char *)base.Data(), base.Size(), (const char *)state->Level.Data(), state->Level.Size());
+		if (delta.Size() < state->Level.Size() / 2)
+		{
+			state->Level = std::move(delta);
+			state->Delta = true;
+		}
+	}
+	RewindStates.Push(state);
+
+	while (RewindStates.Size() > (unsigned)max<int>(rewind_slots, 1))
+	{
+		G_DropOldestRewindState();
+	}
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+void G_ClearRewindStates()
+{
+	if (!RestoringState)
+	{
+		RewindStates.DeleteAndClear();
+	}
+}
+
+//==========================================================================
+//
+// G_DoRewind
+//
+// Restores the ring entry selected by the rewind command. Everything
+// newer than that entry is discarded.
+//
+//==========================================================================
+
+void G_DoRewind()
+{
+	gameaction = ga_nothing;
+	if (RewindTarget < 0 || RewindTarget >= (int)RewindStates.Size())
+	{
+		return;
+	}
+
+	TArray<char> level;
+	if (!G_GetStateLevel(RewindTarget, level))
+	{
+		Printf(PRINT_HIGH, "Unable to rewind: state is damaged\n");
+		return;
+	}
+	while (RewindStates.Size() > (unsigned)RewindTarget + 1)
+	{
+		delete RewindStates.Last();
+		RewindStates.Pop();
+	}
+
+	RestoringState = true;
+	if (!G_RestoreState(RewindStates[RewindTarget], level.Data(), level.Size(), nullptr))
+	{
+		Printf(PRINT_HIGH, "Unable to rewind: state is damaged\n");
+	}
+	RestoringState = false;
+	RewindTarget = -1;
+}
+
+CCMD(rewind)
+{
+	if (argv.argc() != 2)
+	{
+		size_t bytes = 0;
+		for (auto state : RewindStates) bytes += state->Level.Size() + state->Globals.Size();
+		Printf("usage: rewind <seconds>\n");
+		Printf("%u states, %zu KB\n", RewindStates.Size(), bytes / 1024);
+		return;
+	}
+	if (netgame)
+	{
+		Printf("cannot rewind during a network game\n");
+		return;
+	}
+	if (demorecording || gamestate != GS_LEVEL)
+	{
+		Printf("cannot rewind now\n");
+		return;
+	}
+	if (RewindStates.Size() == 0)
+	{
+		Printf("nothing to rewind to%s\n", rewind_interval <= 0 ? " (rewind_interval is 0)" : "");
+		return;
+	}
+
+	int target = primaryLevel->time - int(atof(argv[1]) * TICRATE);
+	RewindTarget = 0;
+	for (int i = RewindStates.Size() - 1; i >= 0; i--)
+	{
+		if (RewindStates[i]->Time <= target)
+		{
+			RewindTarget = i;
+			break;
+		}
+	}
+	gameaction = ga_rewind;
+}
+
+//==========================================================================
+//
+// G_KeepSaveState
+//
+// Called when a savegame is about to be written. Captures the same state
+// in binary form, so that loading the same file again can skip the file,
+// the decompression and the JSON parser entirely. The state only becomes
+// usable once the file has been written, and only as long as the file
+// stays unchanged. Other hub levels keep their snapshots as they are.
+//
+//==========================================================================
+
+void G_KeepSaveState(const FString &filename)
+{
+	delete SaveState;
+	SaveState = nullptr;
+	if (!save_quickloadram || netgame)
+	{
+		return;
+	}
+
+	auto captured = G_CaptureState();
+	if (captured == nullptr) return;
+
+	auto state = new FKeptSave;
+	state->Filename = filename;
+	state->State = captured;
+
+	auto addhub = [&](level_info_t *info)
+	{
+		if (info != primaryLevel->info && info->Snapshot.mBuffer != nullptr)
+		{
+			state->Hubs.Push({ info->MapName, CopyBuffer(info->Snapshot) });
+		}
+	};
+	for (auto &info : wadlevelinfos) addhub(&info);
+	addhub(&TheDefaultLevelInfo);
+	SaveState = state;
+}
+
+void G_SaveStateWritten(const FString &filename, bool succeeded)
+{
+	if (SaveState == nullptr || SaveState->Filename.Compare(filename) != 0)
+	{
+		return;
+	}
+	if (succeeded && FileSys::FS_GetFileInfo(filename.GetChars(), &SaveState->FileSize, &SaveState->FileTime))
+	{
+		SaveState->Written = true;
+	}
+	else
+	{
+		delete SaveState;
+		SaveState = nullptr;
+	}
+}
+
+bool G_LoadSaveState(const FString &filename)
+{
+	if (SaveState == nullptr || !save_quickloadram || !SaveState->Written || SaveState->Filename.Compare(filename) != 0)
+	{
+		return false;
+	}
+
+	// The file may have been replaced since it was written, e.g. by another instance.
+	uint64_t size;
+	int64_t mtime;
+	if (!FileSys::FS_GetFileInfo(filename.GetChars(), &size, &mtime) || size != SaveState->FileSize || mtime != SaveState->FileTime)
+	{
+		delete SaveState;
+		SaveState = nullptr;
+		return false;
+	}
+
+	G_ClearRewindStates();
+	return G_RestoreState(SaveState->State, SaveState->State->Level.Data(), SaveState->State->Level.Size(), &SaveState->Hubs);
+}
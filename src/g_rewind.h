@@ -0,0 +1,24 @@
+#pragma once
+
+#include "zstring.h"
+
+//==========================================================================
+//
+// In-memory save states
+//
+// With rewind_interval set, a compact snapshot of the game is taken every
+// few tics and kept in a ring that 'rewind <seconds>' can go back to.
+// With save_quickloadram the state of the last savegame is kept in memory
+// as well, in the same binary form, so that loading it again needs
+// neither the zip file, decompression nor the JSON parser.
+//
+//==========================================================================
+
+namespace FileSys { struct FCompressedBuffer; }
+
+void G_RewindTicker();
+void G_DoRewind();
+void G_ClearRewindStates();
+void G_KeepSaveState(const FString &filename);
+void G_SaveStateWritten(const FString &filename, bool succeeded);
+bool G_LoadSaveState(const FString &filename);
@@ -15,6 +15,7 @@ struct FBlockNode
 	FBlockNode *NextActor;			// next actor in this block
 	FBlockNode **PrevBlock;			// previous block this actor is in
 	FBlockNode *NextBlock;			// next block this actor is in
+	unsigned ThingIndex;			// slot in FBlockmap::blockthings for this block
 
 	static FBlockNode *Create (AActor *who, int x, int y, int group = -1);
 	void Release ();
@@ -22,6 +23,26 @@ struct FBlockNode
 	static FBlockNode *FreeBlocks;
 };
 
+// Same contents as a block's FBlockNode chain, stored contiguously for faster
+// iteration. The most recently linked actor is last, so walking the array
+// backwards gives the same order as the chain. That order decides which
+// actor is found first by P_CheckPosition, radius attacks and monster
+// searches, so it must be kept for demo and network sync. Unlinking
+// therefore leaves a hole (Me == nullptr) instead of moving the last entry
+// into the slot, and the holes get squeezed out once they make up half of
+// the array. Anything that walks the array must skip them.
+struct FBlockThing
+{
+	AActor *Me;
+	FBlockNode *Node;
+};
+
+struct FBlockThings
+{
+	TArray<FBlockThing> Things;
+	unsigned Holes = 0;
+};
+
 // BLOCKMAP
 // Created from axis aligned bounding box
 // of the map, a rectangular array of
@@ -41,6 +62,8 @@ struct FBlockmap
 	double				bmaporgy;		// origin of block map
 	FBlockNode**		blocklinks; 	// for thing chains
 
+	FBlockThings*		blockthings;	// contiguous copy of blocklinks, see FBlockThing
+
 	// mapblocks are used to check movement
 	// against lines and things
 	static constexpr int MAPBLOCKUNITS = 128;
@@ -72,6 +95,31 @@ struct FBlockmap
 
 	bool VerifyBlockMap(int count, unsigned numlines);
 
+	void LinkThing(FBlockNode *node)
+	{
+		node->ThingIndex = blockthings[node->BlockIndex].Things.Push({ node->Me, node });
+	}
+
+	void UnlinkThing(FBlockNode *node)
+	{
+		auto &block = blockthings[node->BlockIndex];
+		block.Things[node->ThingIndex].Me = nullptr;
+		block.Holes++;
+		// Actors often leave a block in the reverse order they entered it, so the end is trimmed right away.
+		while (block.Things.Size() > 0 && block.Things.Last().Me == nullptr)
+		{
+			block.Things.Pop();
+			block.Holes--;
+		}
+		if (block.Holes >= 16 && block.Holes * 2 >= block.Things.Size())
+		{
+			CompactThings(block);
+		}
+	}
+
+	void CompactThings(FBlockThings &block);
+	void RebuildThings(int index);
+
 	void Clear()
 	{
 		if (blockmaplump != nullptr)
@@ -84,6 +132,11 @@ struct FBlockmap
 			delete[] blocklinks;
 			blocklinks = nullptr;
 		}
+		if (blockthings != nullptr)
+		{
+			delete[] blockthings;
+			blockthings = nullptr;
+		}
 	}
 
 	~FBlockmap()
@@ -65,6 +65,7 @@
 #include "d_net.h"
 
 EXTERN_CVAR(Bool, save_formatted)
+EXTERN_CVAR(Bool, save_binary)
 
 //==========================================================================
 //
@@ -927,6 +928,8 @@ void FLevelLocals::Serialize(FSerializer &arc, bool hubload)
 	}
 	else
 	{
+		P_InvalidateSightCache();
+
 		// prevent bad things from happening by doing a check on the size of level arrays and the map's entire checksum.
 		// The old code happily tried to load savegames with any mismatch here, often causing meaningless errors
 		// deep down in the deserializer or just a crash if the few insufficient safeguards were not triggered.
@@ -1068,11 +1071,12 @@ void FLevelLocals::Serialize(FSerializer &arc, bool hubload)
 
 //==========================================================================
 //
-// Archives the current level
+// Archives the current level. An uncompressed snapshot is only
+// meant to be compressed by the background savegame writer.
 //
 //==========================================================================
 
-void FLevelLocals::SnapshotLevel()
+void FLevelLocals::SnapshotLevel(bool compress)
 {
 	info->Snapshot.Clean();
 
@@ -1080,11 +1084,11 @@ void FLevelLocals::SnapshotLevel()
 	{
 		FDoomSerializer arc(this);
 
-		if (arc.OpenWriter(save_formatted))
+		if (arc.OpenWriter(save_formatted, save_binary))
 		{
 			SaveVersion = SAVEVER;
 			Serialize(arc, false);
-			info->Snapshot = arc.GetCompressedOutput();
+			info->Snapshot = compress ? arc.GetCompressedOutput() : arc.GetStoredOutput();
 		}
 	}
 }
@@ -394,6 +394,7 @@ void FLevelLocals::ClearLevelData(bool fullgc)
 void P_FreeLevelData (bool fullgc)
 {
 	R_FreePastViewers();
+	P_InvalidateSightCache();
 
 	for (auto Level : AllLevels())
 	{
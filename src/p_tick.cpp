@@ -39,6 +39,8 @@
 #include "actorinlines.h"
 #include "g_game.h"
 #include "i_interface.h"
+#include "p_benchmark.h"
+#include "zoneprofiler.h"
 
 extern gamestate_t wipegamestate;
 extern uint8_t globalfreeze, globalchangefreeze;
@@ -77,6 +79,7 @@ bool P_CheckTickerPaused ()
 //
 void P_Ticker (void)
 {
+	FProfileZone zone("P_Ticker");
 	int i;
 
 	for (auto Level : AllLevels())
@@ -114,6 +117,7 @@ void P_Ticker (void)
 	}
 
 	DPSprite::NewTick();
+	P_InvalidateSightCache();
 
 	// [RH] Frozen mode is only changed every 4 tics, to make it work with A_Tracer().
 	// This may not be perfect but it is not really relevant for sublevels that tracer homing behavior is preserved.
@@ -170,7 +174,10 @@ void P_Ticker (void)
 		// [ZZ] call the WorldTick hook
 		Level->localEventManager->WorldTick();
 		Level->Tick();			// [RH] let the level tick
-		Level->Thinkers.RunThinkers(Level);
+		{
+			FBenchScope bench(BENCH_Thinkers);
+			Level->Thinkers.RunThinkers(Level);
+		}
 
 		//if added by MC: Freeze mode.
 		if (!Level->isFrozen())
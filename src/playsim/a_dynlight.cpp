@@ -67,6 +67,8 @@
 
 static FMemArena DynLightArena(sizeof(FDynamicLight) * 200);
 static TArray<FDynamicLight*> FreeList;
+static FMemArena LightNodeArena(sizeof(FLightNode) * 1000);
+static TArray<FLightNode*> FreeNodeList;
 static FCRandom randLight;
 
 extern TArray<FLightDefaults *> StateLights;
@@ -420,32 +422,40 @@ void FDynamicLight::UpdateLocation()
 //
 // These have been copied from the secnode code and modified for the light links
 //
-// P_AddSecnode() searches the current list to see if this sector is
-// already there. If not, it adds a sector node at the head of the list of
-// sectors this object appears in. This is called when creating a list of
-// nodes that will get linked in later. Returns a pointer to the new node.
+// AddLightNode() checks if the light already had a node for this target
+// when it was linked the last time. If not, it adds a node at the head of
+// the list of targets this light touches. Returns a pointer to the new head.
+//
+// Instead of searching the light's list like P_AddSecnode does, the old
+// nodes are looked up by the target's index. Lights with large radii touch
+// hundreds of sides, which made relinking a moving light quadratic.
 //
 //=============================================================================
 
-FLightNode * AddLightNode(FLightNode ** thread, void * linkto, FDynamicLight * light, FLightNode *& nextnode)
+static TArray<FLightNode*> OldSectionNodes;
+static TArray<FLightNode*> OldSideNodes;
+
+static void GrowNodeTable(TArray<FLightNode*> &table, unsigned size)
 {
-	FLightNode * node;
+	for (unsigned i = table.Size(); i < size; i++) table.Push(nullptr);
+}
 
-	node = nextnode;
-	while (node)
-    {
-		if (node->targ==linkto)   // Already have a node for this sector?
-		{
-			node->lightsource = light; // Yes. Setting m_thing says 'keep it'.
-			return(nextnode);
-		}
-		node = node->nextTarget;
-    }
+static FLightNode * AddLightNode(FLightNode ** thread, void * linkto, FDynamicLight * light, FLightNode *& nextnode, FLightNode *& oldnode)
+{
+	FLightNode * node = oldnode;
 
-	// Couldn't find an existing node for this sector. Add one at the head
+	if (node)   // Already have a node for this target?
+	{
+		node->lightsource = light; // Yes. Setting lightsource says 'keep it'.
+		return(nextnode);
+	}
+
+	// Couldn't find an existing node for this target. Add one at the head
 	// of the list.
 	
-	node = new FLightNode;
+	if (FreeNodeList.Size()) FreeNodeList.Pop(node);
+	else node = (FLightNode*)LightNodeArena.Alloc(sizeof(FLightNode));
+	oldnode = node;
 	
 	node->targ = linkto;
 	node->lightsource = light; 
@@ -488,7 +498,7 @@ static FLightNode * DeleteLightNode(FLightNode * node)
 		
 		// Return this node to the freelist
 		tn=node->nextTarget;
-		delete node;
+		FreeNodeList.Push(node);
 		return(tn);
 	}
 	return(nullptr);
@@ -550,7 +560,7 @@ void FDynamicLight::CollectWithinRadius(const DVector3 &opos, FSection *section,
 		auto pos = collected_ss[i].pos;
 		section = collected_ss[i].sect;
 
-		touching_sector = AddLightNode(&section->lighthead, section, this, touching_sector);
+		touching_sector = AddLightNode(&section->lighthead, section, this, touching_sector, OldSectionNodes[Level->sections.SectionIndex(section)]);
 
 
 		auto processSide = [&](side_t *sidedef, const vertex_t *v1, const vertex_t *v2)
@@ -562,7 +572,7 @@ void FDynamicLight::CollectWithinRadius(const DVector3 &opos, FSection *section,
 				if ((pos.Y - v1->fY()) * (v2->fX() - v1->fX()) + (v1->fX() - pos.X) * (v2->fY() - v1->fY()) <= 0)
 				{
 					linedef->validcount = ::validcount;
-					touching_sides = AddLightNode(&sidedef->lighthead, sidedef, this, touching_sides);
+					touching_sides = AddLightNode(&sidedef->lighthead, sidedef, this, touching_sides, OldSideNodes[sidedef->Index()]);
 				}
 				else if (linedef->sidedef[0] == sidedef && linedef->sidedef[1] == nullptr)
 				{
@@ -666,17 +676,22 @@ void FDynamicLight::LinkLight()
 {
 	// mark the old light nodes
 	FLightNode * node;
+
+	GrowNodeTable(OldSectionNodes, Level->sections.allSections.Size());
+	GrowNodeTable(OldSideNodes, Level->sides.Size());
 	
 	node = touching_sides;
 	while (node)
     {
 		node->lightsource = nullptr;
+		OldSideNodes[node->targLine->Index()] = node;
 		node = node->nextTarget;
     }
 	node = touching_sector;
 	while (node)
 	{
 		node->lightsource = nullptr;
+		OldSectionNodes[Level->sections.SectionIndex((FSection*)node->targ)] = node;
 		node = node->nextTarget;
 	}
 
@@ -692,11 +707,13 @@ void FDynamicLight::LinkLight()
 	}
 		
 	// Now delete any nodes that won't be used. These are the ones where
-	// m_thing is still nullptr.
+	// lightsource is still nullptr. This also clears the lookup tables
+	// for the next light.
 	
 	node = touching_sides;
 	while (node)
 	{
+		OldSideNodes[node->targLine->Index()] = nullptr;
 		if (node->lightsource == nullptr)
 		{
 			node = DeleteLightNode(node);
@@ -708,6 +725,7 @@ void FDynamicLight::LinkLight()
 	node = touching_sector;
 	while (node)
 	{
+		OldSectionNodes[Level->sections.SectionIndex((FSection*)node->targ)] = nullptr;
 		if (node->lightsource == nullptr)
 		{
 			node = DeleteLightNode(node);
@@ -45,6 +45,7 @@
 #include "v_video.h"
 #include "g_cvars.h"
 #include "d_main.h"
+#include "zoneprofiler.h"
 
 #include "p_visualthinker.h"
 
@@ -69,6 +70,31 @@ struct ProfileInfo
 
 static TMap<FName, ProfileInfo> Profiles;
 static unsigned int profilethinkers, profilelimit;
+
+// Accumulated over multiple tics by 'profilescripts'
+struct ClassProfileInfo
+{
+	int numcalls = 0;
+	double time = 0;
+};
+
+static TMap<FName, ClassProfileInfo> ClassProfiles;
+static bool profilescripts;
+static int profiledtics;
+
+static void AccumulateClassProfiles()
+{
+	TMap<FName, ProfileInfo>::Iterator it(Profiles);
+	TMap<FName, ProfileInfo>::Pair *pair;
+	while (it.NextPair(pair))
+	{
+		auto &acc = ClassProfiles[pair->Key];
+		acc.numcalls += pair->Value.numcalls;
+		acc.time += pair->Value.timer.TimeMS();
+	}
+	profiledtics++;
+}
+
 DThinker *NextToThink;
 
 //==========================================================================
@@ -100,6 +126,7 @@ void FThinkerCollection::Link(DThinker *thinker, int statnum)
 
 void FThinkerCollection::RunThinkers(FLevelLocals *Level)
 {
+	FProfileZone zone("RunThinkers");
 	int i, count;
 
 	ThinkCount = 0;
@@ -141,11 +168,12 @@ void FThinkerCollection::RunThinkers(FLevelLocals *Level)
 		}
 	};
 
-	if (!profilethinkers)
+	if (!profilethinkers && !profilescripts)
 	{
 		// Tick every thinker left from last time
 		for (i = STAT_FIRST_THINKING; i <= MAX_STATNUM; ++i)
 		{
+			if (i == STAT_DEFAULT) P_PrefetchSight(Level);
 			Thinkers[i].TickThinkers(nullptr);
 		}
 
@@ -176,6 +204,7 @@ void FThinkerCollection::RunThinkers(FLevelLocals *Level)
 		// Tick every thinker left from last time
 		for (i = STAT_FIRST_THINKING; i <= MAX_STATNUM; ++i)
 		{
+			if (i == STAT_DEFAULT) P_PrefetchSight(Level);
 			Thinkers[i].ProfileThinkers(nullptr);
 		}
 
@@ -206,62 +235,70 @@ void FThinkerCollection::RunThinkers(FLevelLocals *Level)
 		}
 
 
-		struct SortedProfileInfo
+		if (profilescripts)
 		{
-			const char* className;
-			int numcalls;
-			double time;
-		};
-
-		TArray<SortedProfileInfo> sorted;
-		sorted.Grow(Profiles.CountUsed());
-
-		auto it = TMap<FName, ProfileInfo>::Iterator(Profiles);
-		TMap<FName, ProfileInfo>::Pair *pair;
-		while (it.NextPair(pair))
-		{
-			sorted.Push({ pair->Key.GetChars(), pair->Value.numcalls, pair->Value.timer.TimeMS() });
+			AccumulateClassProfiles();
 		}
 
-		std::sort(sorted.begin(), sorted.end(), [](const SortedProfileInfo& left, const SortedProfileInfo& right)
+		if (profilethinkers)
 		{
-			switch (profilethinkers)
+			struct SortedProfileInfo
+			{
+				const char* className;
+				int numcalls;
+				double time;
+			};
+
+			TArray<SortedProfileInfo> sorted;
+			sorted.Grow(Profiles.CountUsed());
+
+			auto it = TMap<FName, ProfileInfo>::Iterator(Profiles);
+			TMap<FName, ProfileInfo>::Pair *pair;
+			while (it.NextPair(pair))
 			{
-			case 1: // by name, from A to Z
-				return stricmp(left.className, right.className) < 0;
-			case 2: // by name, from Z to A
-				return stricmp(right.className, left.className) < 0;
-			case 3: // number of calls, ascending
-				return left.numcalls < right.numcalls;
-			case 4: // number of calls, descending
-				return right.numcalls < left.numcalls;
-			case 5: // average time, ascending
-				return left.time / left.numcalls < right.time / right.numcalls;
-			case 6: // average time, descending
-				return right.time / right.numcalls < left.time / left.numcalls;
-			case 7: // total time, ascending
-				return left.time < right.time;
-			default: // total time, descending
-				return right.time < left.time;
+				sorted.Push({ pair->Key.GetChars(), pair->Value.numcalls, pair->Value.timer.TimeMS() });
 			}
-		});
 
-		Printf(TEXTCOLOR_YELLOW "Total, ms   Averg, ms   Calls   Actor class\n");
-		Printf(TEXTCOLOR_YELLOW "----------  ----------  ------  --------------------\n");
+			std::sort(sorted.begin(), sorted.end(), [](const SortedProfileInfo& left, const SortedProfileInfo& right)
+			{
+				switch (profilethinkers)
+				{
+				case 1: // by name, from A to Z
+					return stricmp(left.className, right.className) < 0;
+				case 2: // by name, from Z to A
+					return stricmp(right.className, left.className) < 0;
+				case 3: // number of calls, ascending
+					return left.numcalls < right.numcalls;
+				case 4: // number of calls, descending
+					return right.numcalls < left.numcalls;
+				case 5: // average time, ascending
+					return left.time / left.numcalls < right.time / right.numcalls;
+				case 6: // average time, descending
+					return right.time / right.numcalls < left.time / left.numcalls;
+				case 7: // total time, ascending
+					return left.time < right.time;
+				default: // total time, descending
+					return right.time < left.time;
+				}
+			});
 
-		const unsigned count = min(profilelimit > 0 ? profilelimit : UINT_MAX, sorted.Size());
+			Printf(TEXTCOLOR_YELLOW "Total, ms   Averg, ms   Calls   Actor class\n");
+			Printf(TEXTCOLOR_YELLOW "----------  ----------  ------  --------------------\n");
 
-		for (unsigned i = 0; i < count; ++i)
-		{
-			const SortedProfileInfo& info = sorted[i];
-			Printf("%s%10.6f  %s%10.6f  %s%6d  %s%s\n",
-				profilethinkers >= 7 ? TEXTCOLOR_YELLOW : TEXTCOLOR_WHITE, info.time,
-				profilethinkers == 5 || profilethinkers == 6 ? TEXTCOLOR_YELLOW : TEXTCOLOR_WHITE, info.time / info.numcalls,
-				profilethinkers == 3 || profilethinkers == 4 ? TEXTCOLOR_YELLOW : TEXTCOLOR_WHITE, info.numcalls,
-				profilethinkers == 1 || profilethinkers == 2 ? TEXTCOLOR_YELLOW : TEXTCOLOR_WHITE, info.className);
-		}
+			const unsigned count = min(profilelimit > 0 ? profilelimit : UINT_MAX, sorted.Size());
+
+			for (unsigned i = 0; i < count; ++i)
+			{
+				const SortedProfileInfo& info = sorted[i];
+				Printf("%s%10.6f  %s%10.6f  %s%6d  %s%s\n",
+					profilethinkers >= 7 ? TEXTCOLOR_YELLOW : TEXTCOLOR_WHITE, info.time,
+					profilethinkers == 5 || profilethinkers == 6 ? TEXTCOLOR_YELLOW : TEXTCOLOR_WHITE, info.time / info.numcalls,
+					profilethinkers == 3 || profilethinkers == 4 ? TEXTCOLOR_YELLOW : TEXTCOLOR_WHITE, info.numcalls,
+					profilethinkers == 1 || profilethinkers == 2 ? TEXTCOLOR_YELLOW : TEXTCOLOR_WHITE, info.className);
+			}
 
-		profilethinkers = 0;
+			profilethinkers = 0;
+		}
 	}
 
 	ThinkCycles.Unclock();
@@ -870,6 +907,128 @@ CCMD(profilethinkers)
 	}
 }
 
+//==========================================================================
+//
+// profilescripts
+//
+// Accumulates thinker time per class and script function time over
+// as many tics as needed and shows the most expensive ones.
+//
+//==========================================================================
+
+struct SortedClassProfile
+{
+	const char *className;
+	int numcalls;
+	double time;
+};
+
+static void GetSortedClassProfiles(TArray<SortedClassProfile> &sorted)
+{
+	sorted.Clear();
+	TMap<FName, ClassProfileInfo>::Iterator it(ClassProfiles);
+	TMap<FName, ClassProfileInfo>::Pair *pair;
+	while (it.NextPair(pair))
+	{
+		sorted.Push({ pair->Key.GetChars(), pair->Value.numcalls, pair->Value.time });
+	}
+	std::sort(sorted.begin(), sorted.end(), [](const SortedClassProfile &left, const SortedClassProfile &right)
+	{
+		return right.time < left.time;
+	});
+}
+
+static void ResetScriptProfiles()
+{
+	ClassProfiles.Clear();
+	profiledtics = 0;
+	VMProfile_Reset();
+}
+
+CCMD(profilescripts)
+{
+	if (argv.argc() >= 2 && !stricmp(argv[1], "start"))
+	{
+		ResetScriptProfiles();
+		profilescripts = true;
+		VMProfile_Enable(true);
+	}
+	else if (argv.argc() >= 2 && !stricmp(argv[1], "stop"))
+	{
+		profilescripts = false;
+		VMProfile_Enable(false);
+	}
+	else if (argv.argc() >= 2 && !stricmp(argv[1], "reset"))
+	{
+		ResetScriptProfiles();
+	}
+	else if (argv.argc() >= 2 && !stricmp(argv[1], "dump"))
+	{
+		const unsigned limit = argv.argc() >= 3 ? max(atoi(argv[2]), 1) : 20;
+		const int tics = max(profiledtics, 1);
+
+		TArray<SortedClassProfile> classes;
+		GetSortedClassProfiles(classes);
+		Printf(TEXTCOLOR_YELLOW "Thinker time per class over %d tics\n", profiledtics);
+		Printf(TEXTCOLOR_YELLOW "Total, ms   Per tic, ms   Calls     Actor class\n");
+		Printf(TEXTCOLOR_YELLOW "----------  -----------  --------  --------------------\n");
+		for (unsigned i = 0; i < min(limit, classes.Size()); i++)
+		{
+			auto &info = classes[i];
+			Printf("%10.3f  %11.4f  %8d  %s\n", info.time, info.time / tics, info.numcalls, info.className);
+		}
+
+		TArray<FScriptProfileInfo> funcs;
+		VMProfile_GetSorted(funcs);
+		Printf(TEXTCOLOR_YELLOW "\nScript function time (self time excludes called script functions)\n");
+		Printf(TEXTCOLOR_YELLOW "Self, ms    Total, ms   Calls     Function\n");
+		Printf(TEXTCOLOR_YELLOW "----------  ----------  --------  --------------------\n");
+		for (unsigned i = 0; i < min(limit, funcs.Size()); i++)
+		{
+			auto &info = funcs[i];
+			Printf("%10.3f  %10.3f  %8d  %s\n", info.Self, info.Total, info.Calls, info.Name);
+		}
+	}
+	else
+	{
+		Printf(
+			"Usage: profilescripts start\n"
+			"       profilescripts stop\n"
+			"       profilescripts reset\n"
+			"       profilescripts dump [count]\n\n"
+			"Collects thinker time per class and time per script function until stopped.\n"
+			"Use 'stat scripts' to watch the most expensive ones while playing.\n");
+	}
+}
+
+ADD_STAT(scripts)
+{
+	if (!profilescripts)
+	{
+		return "Not profiling. Use 'profilescripts start' first.";
+	}
+
+	FString out;
+	const int tics = max(profiledtics, 1);
+
+	TArray<SortedClassProfile> classes;
+	GetSortedClassProfiles(classes);
+	out.AppendFormat("Thinker classes per tic (%d tics):\n", profiledtics);
+	for (unsigned i = 0; i < min(8u, classes.Size()); i++)
+	{
+		out.AppendFormat("  %7.4f ms %7.1f calls  %s\n", classes[i].time / tics, double(classes[i].numcalls) / tics, classes[i].className);
+	}
+
+	TArray<FScriptProfileInfo> funcs;
+	VMProfile_GetSorted(funcs);
+	out.AppendFormat("Script functions per tic (self time):\n");
+	for (unsigned i = 0; i < min(8u, funcs.Size()); i++)
+	{
+		out.AppendFormat("  %7.4f ms %7.1f calls  %s\n", funcs[i].Self / tics, double(funcs[i].Calls) / tics, funcs[i].Name);
+	}
+	return out;
+}
+
 //==========================================================================
 //
 //
@@ -889,7 +1048,10 @@ DEFINE_ACTION_FUNCTION(DThinker, Tick)
 
 void DThinker::CallTick()
 {
-	IFVIRTUAL(DThinker, Tick)
+	// Named after the class so that the trace shows which actor types are expensive.
+	FProfileZone zone(GetClass()->TypeName.GetChars());
+	// Most thinkers, including all actors without a ZScript Tick, still use the native one.
+	IFOVERRIDENVIRTUAL(DThinker, Tick)
 	{
 		// Without the type cast this picks the 'void *' assignment...
 		VMValue params[1] = { (DObject*)this };
@@ -2140,6 +2140,7 @@ void FParser::SF_SetLineBlocking(void)
 			{
 				Level->lines[i].flags = (Level->lines[i].flags & ~(ML_BLOCKING | ML_BLOCKEVERYTHING)) | blocking;
 			}
+			P_InvalidateSightCache();
 		}
 	}
 }
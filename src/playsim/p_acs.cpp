@@ -78,6 +78,7 @@
 #include "s_music.h"
 #include "v_video.h"
 #include "texturemanager.h"
+#include "p_benchmark.h"
 
 	// P-codes for ACS scripts
 	enum
@@ -3413,6 +3414,7 @@ cycle_t ACSTime;
 
 void DACSThinker::Tick ()
 {
+	FBenchScope bench(BENCH_ACS);
 	ACSTime.Reset();
 	ACSTime.Clock();
 	DLevelScript *script = Scripts;
@@ -9079,6 +9081,7 @@ scriptwait:
 						break;
 					}
 				}
+				P_InvalidateSightCache();
 
 				sp -= 2;
 			}
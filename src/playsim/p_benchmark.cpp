@@ -0,0 +1,211 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright 2024 GZDoom Maintainers and Contributors
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//		Headless playsim benchmark. Runs a demo through G_Ticker as fast
+//		as possible and writes per-tic subsystem timings to a CSV or
+//		JSON file.
+//
+//-----------------------------------------------------------------------------
+
+#include "p_benchmark.h"
+#include "doomstat.h"
+#include "d_net.h"
+#include "d_main.h"
+#include "g_game.h"
+#include "m_argv.h"
+#include "dobjgc.h"
+#include "printf.h"
+#include "files.h"
+#include "engineerrors.h"
+
+extern cycle_t VMCycles[10];
+void G_BuildTiccmd(ticcmd_t *cmd);
+void D_DoAdvanceDemo();
+
+bool benchplaysim;
+FBenchSection BenchSections[NUM_BENCHSECTIONS];
+
+struct FBenchTic
+{
+	int Tic;
+	double TicMS;
+	double VMMS;
+	double SectionMS[NUM_BENCHSECTIONS];
+	int SectionCalls[NUM_BENCHSECTIONS];
+};
+
+static TArray<FBenchTic> BenchTics;
+
+static const char *const BenchSectionNames[NUM_BENCHSECTIONS] =
+{
+	"thinkers",
+	"sight",
+	"trymove",
+	"acs",
+};
+
+//==========================================================================
+//
+// P_RunPlaysimBenchmark
+//
+// Replacement for D_DoomLoop while -benchplaysim is active. This does
+// the same as the singletics path but skips input, sound and display
+// so that only the simulation gets measured. The loop is left through
+// P_FinishPlaysimBenchmark once the demo ends.
+//
+//==========================================================================
+
+void P_RunPlaysimBenchmark()
+{
+	cycle_t ticcycles;
+
+	for (;;)
+	{
+		for (auto &section : BenchSections)
+		{
+			section.Cycles.Reset();
+			section.Depth = 0;
+			section.Calls = 0;
+		}
+		double vmstart = VMCycles[0].TimeMS();
+		ticcycles.Reset();
+		ticcycles.Clock();
+
+		G_BuildTiccmd(&netcmds[consoleplayer][maketic%BACKUPTICS]);
+		if (advancedemo)
+			D_DoAdvanceDemo();
+		G_Ticker();
+		gametic++;
+		maketic++;
+		GC::CheckGC();
+		Net_NewMakeTic();
+
+		ticcycles.Unclock();
+
+		// Tics spent loading the demo's level are not part of the simulation.
+		if (gamestate != GS_LEVEL) continue;
+
+		auto &tic = BenchTics[BenchTics.Reserve(1)];
+		tic.Tic = gametic - 1;
+		tic.TicMS = ticcycles.TimeMS();
+		tic.VMMS = VMCycles[0].TimeMS() - vmstart;
+		for (int i = 0; i < NUM_BENCHSECTIONS; i++)
+		{
+			tic.SectionMS[i] = BenchSections[i].Cycles.TimeMS();
+			tic.SectionCalls[i] = BenchSections[i].Calls;
+		}
+	}
+}
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static void WriteBenchCSV(FileWriter *fw)
+{
+	fw->Printf("tic,total_ms");
+	for (auto name : BenchSectionNames) fw->Printf(",%s_ms,%s_calls", name, name);
+	fw->Printf(",vm_ms\n");
+
+	for (auto &tic : BenchTics)
+	{
+		fw->Printf("%d,%.4f", tic.Tic, tic.TicMS);
+		for (int i = 0; i < NUM_BENCHSECTIONS; i++) fw->Printf(",%.4f,%d", tic.SectionMS[i], tic.SectionCalls[i]);
+		fw->Printf(",%.4f\n", tic.VMMS);
+	}
+}
+
+static void WriteBenchJSON(FileWriter *fw)
+{
+	FString demoname = Args->CheckValue("-benchplaysim");
+	demoname.Substitute("\\", "\\\\");
+	demoname.Substitute("\"", "\\\"");
+
+	fw->Printf("{\n\t\"demo\": \"%s\",\n\t\"tics\": [\n", demoname.GetChars());
+	for (unsigned j = 0; j < BenchTics.Size(); j++)
+	{
+		auto &tic = BenchTics[j];
+		fw->Printf("\t\t{ \"tic\": %d, \"total_ms\": %.4f", tic.Tic, tic.TicMS);
+		for (int i = 0; i < NUM_BENCHSECTIONS; i++)
+		{
+			fw->Printf(", \"%s_ms\": %.4f, \"%s_calls\": %d", BenchSectionNames[i], tic.SectionMS[i], BenchSectionNames[i], tic.SectionCalls[i]);
+		}
+		fw->Printf(", \"vm_ms\": %.4f }%s\n", tic.VMMS, j + 1 < BenchTics.Size() ? "," : "");
+	}
+	fw->Printf("\t]\n}\n");
+}
+
+//==========================================================================
+//
+// P_FinishPlaysimBenchmark
+//
+// Called from G_CheckDemoStatus when the benchmark demo ends. Writes
+// the collected data, prints a summary and exits.
+//
+//==========================================================================
+
+void P_FinishPlaysimBenchmark()
+{
+	double total = 0, worst = 0, sections[NUM_BENCHSECTIONS] = {}, vm = 0;
+	int worsttic = 0;
+
+	for (auto &tic : BenchTics)
+	{
+		total += tic.TicMS;
+		vm += tic.VMMS;
+		for (int i = 0; i < NUM_BENCHSECTIONS; i++) sections[i] += tic.SectionMS[i];
+		if (tic.TicMS > worst)
+		{
+			worst = tic.TicMS;
+			worsttic = tic.Tic;
+		}
+	}
+
+	const char *outname = Args->CheckValue("-benchout");
+	if (outname == nullptr) outname = "benchplaysim.csv";
+	size_t namelen = strlen(outname);
+	bool json = namelen > 5 && !stricmp(outname + namelen - 5, ".json");
+
+	FileWriter *fw = FileWriter::Open(outname);
+	if (fw == nullptr)
+	{
+		Printf(PRINT_HIGH, "Unable to save benchmark results to %s\n", outname);
+	}
+	else
+	{
+		if (json) WriteBenchJSON(fw);
+		else WriteBenchCSV(fw);
+		delete fw;
+		Printf("Benchmark results written to %s\n", outname);
+	}
+
+	unsigned numtics = max(BenchTics.Size(), 1u);
+	Printf("Simulated %u tics in %.1f ms (%.3f ms/tic avg, worst %.3f ms at tic %d)\n", BenchTics.Size(), total, total / numtics, worst, worsttic);
+	for (int i = 0; i < NUM_BENCHSECTIONS; i++)
+	{
+		Printf("  %-10s %10.1f ms (%.3f ms/tic)\n", BenchSectionNames[i], sections[i], sections[i] / numtics);
+	}
+	Printf("  %-10s %10.1f ms (%.3f ms/tic)\n", "vm", vm, vm / numtics);
+
+	BenchTics.Reset();
+	throw CExitEvent(0);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "stats.h"
+
+//==========================================================================
+//
+// Headless playsim benchmark (-benchplaysim)
+//
+// Plays back a demo without renderer, window or sound and records how
+// much time each tic spends in the major playsim subsystems.
+//
+//==========================================================================
+
+enum EBenchSection
+{
+	BENCH_Thinkers,
+	BENCH_Sight,
+	BENCH_TryMove,
+	BENCH_ACS,
+	NUM_BENCHSECTIONS
+};
+
+struct FBenchSection
+{
+	cycle_t Cycles;
+	int Depth;
+	int Calls;
+};
+
+extern bool benchplaysim;
+extern FBenchSection BenchSections[NUM_BENCHSECTIONS];
+
+// Times one benchmark section for the lifetime of the object.
+// Only the outermost scope of a section gets clocked so that recursive
+// calls (e.g. P_TryMove through a teleporter) are not counted twice.
+class FBenchScope
+{
+	FBenchSection *section = nullptr;
+
+public:
+	explicit FBenchScope(EBenchSection s)
+	{
+		if (benchplaysim)
+		{
+			section = &BenchSections[s];
+			section->Calls++;
+			if (section->Depth++ == 0) section->Cycles.Clock();
+		}
+	}
+
+	~FBenchScope()
+	{
+		if (section != nullptr && --section->Depth == 0) section->Cycles.Unclock();
+	}
+
+	FBenchScope(const FBenchScope &) = delete;
+	FBenchScope &operator=(const FBenchScope &) = delete;
+};
+
+void G_BenchPlaysim(const char *demoname);
+void P_RunPlaysimBenchmark();
+void P_FinishPlaysimBenchmark();
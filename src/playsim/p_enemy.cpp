@@ -1530,13 +1530,15 @@ int P_LookForMonsters (AActor *actor)
 AActor *LookForTIDInBlock (AActor *lookee, int index, void *extparams)
 {
 	FLookExParams *params = (FLookExParams *)extparams;
-	FBlockNode *block;
 	AActor *link;
 	AActor *other;
+	auto &things = lookee->Level->blockmap.blockthings[index].Things;
 	
-	for (block = lookee->Level->blockmap.blocklinks[index]; block != NULL; block = block->NextActor)
+	for (int i = things.Size() - 1; i >= 0; i--)
 	{
-		link = block->Me;
+		link = things[i].Me;
+		if (link == nullptr)
+			continue;
 
         if (!(link->flags & MF_SHOOTABLE))
 			continue;			// not shootable (observer or dead)
@@ -1700,17 +1702,16 @@ int P_LookForTID (AActor *actor, INTBOOL allaround, FLookExParams *params)
 
 AActor *LookForEnemiesInBlock (AActor *lookee, int index, void *extparam)
 {
-	FBlockNode *block;
-	AActor *link;
-	AActor *other;
 	FLookExParams *params = (FLookExParams *)extparam;
+	auto &things = lookee->Level->blockmap.blockthings[index].Things;
 	
-	for (block = lookee->Level->blockmap.blocklinks[index]; block != NULL; block = block->NextActor)
+	for (int i = things.Size() - 1; i >= 0; i--)
 	{
-		if (!ValidEnemyInBlock(lookee, block->Me, params))
+		AActor *link = things[i].Me;
+		if (link == nullptr || !ValidEnemyInBlock(lookee, link, params))
 			continue;
 
-		return block->Me;
+		return link;
 	}
 	return NULL;
 }
@@ -2783,6 +2783,7 @@ FUNC(LS_Line_SetBlocking)
         Level->lines[line].flags = (Level->lines[line].flags & ~clearflags[0]) | setflags[0];
         Level->lines[line].flags2 = (Level->lines[line].flags2 & ~clearflags[1]) | setflags[1];
     }
+    P_InvalidateSightCache();
     return true;
 }
 
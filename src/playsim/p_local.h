@@ -280,6 +280,8 @@ enum ESightFlags
 	SF_IGNOREWATERBOUNDARY=8
 };
 
+void	P_InvalidateSightCache ();
+void	P_PrefetchSight (FLevelLocals *Level);
 void	P_ResetSightCounters (bool full);
 bool	P_TalkFacing (AActor *player);
 void	P_UseLines (player_t* player);
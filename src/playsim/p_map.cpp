@@ -94,6 +94,7 @@
 #include "r_sky.h"
 #include "g_levellocals.h"
 #include "actorinlines.h"
+#include "p_benchmark.h"
 #include <shadowinlines.h>
 
 CVAR(Bool, cl_bloodsplats, true, CVAR_ARCHIVE)
@@ -158,9 +159,13 @@ bool P_CanCollideWith(AActor *tmthing, AActor *thing)
 	int retval;
 	ret.IntAt(&retval);
 
+	// Actor's own version always returns true, so it only needs to be called if a class replaced it.
+	// This is checked on every pair of actors that touch, and very few classes override it.
+	VMFunction *deffunc = RUNTIME_CLASS(AActor)->Virtuals[VIndex];
+
 	auto clss = tmthing->GetClass();
 	VMFunction *func = clss->Virtuals.Size() > VIndex ? clss->Virtuals[VIndex] : nullptr;
-	if (func != nullptr)
+	if (func != nullptr && func != deffunc)
 	{
 		VMCall(func, params, 3, &ret, 1);
 		if (!retval) return false;
@@ -171,7 +176,7 @@ bool P_CanCollideWith(AActor *tmthing, AActor *thing)
 	// re-get for the other actor.
 	clss = thing->GetClass();
 	func = clss->Virtuals.Size() > VIndex ? clss->Virtuals[VIndex] : nullptr;
-	if (func != nullptr)
+	if (func != nullptr && func != deffunc)
 	{
 		VMCall(func, params, 3, &ret, 1);
 		if (!retval) return false;
@@ -182,7 +187,7 @@ bool P_CanCollideWith(AActor *tmthing, AActor *thing)
 void P_CollidedWith(AActor* const collider, AActor* const collidee)
 {
 	{
-		IFVIRTUALPTR(collider, AActor, CollidedWith)
+		IFOVERRIDENVIRTUALPTR(collider, AActor, CollidedWith)
 		{
 			VMValue params[] = { collider, collidee, false };
 			VMCall(func, params, 3, nullptr, 0);
@@ -190,7 +195,7 @@ void P_CollidedWith(AActor* const collider, AActor* const collidee)
 	}
 
 	{
-		IFVIRTUALPTR(collidee, AActor, CollidedWith)
+		IFOVERRIDENVIRTUALPTR(collidee, AActor, CollidedWith)
 		{
 			VMValue params[] = { collidee, collider, true };
 			VMCall(func, params, 3, nullptr, 0);
@@ -2346,6 +2351,7 @@ bool P_TryMove(AActor *thing, const DVector2 &pos,
 	int 		oldside;
 	sector_t*	oldsec = thing->Sector;	// [RH] for sector actions
 	sector_t*	newsec;
+	FBenchScope bench(BENCH_TryMove);
 
 	tm.floatok = false;
 	tm.portalstep = false;
@@ -7044,6 +7050,8 @@ bool P_ChangeSector(sector_t *sector, int crunch, double amt, int floorOrCeil, b
 	void(*iterator2)(AActor *, FChangePosition *) = NULL;
 	msecnode_t *n;
 
+	P_InvalidateSightCache();
+
 	cpos.nofit = false;
 	cpos.crushchange = crunch;
 	cpos.moveamt = fabs(amt);
@@ -340,6 +340,7 @@ void AActor::UnlinkFromWorld (FLinkContext *ctx)
 				block->NextActor->PrevActor = block->PrevActor;
 			}
 			*(block->PrevActor) = block->NextActor;
+			Level->blockmap.UnlinkThing(block);
 			FBlockNode *next = block->NextBlock;
 			block->Release ();
 			block = next;
@@ -545,6 +546,7 @@ void AActor::LinkToWorld(FLinkContext *ctx, bool spawningmapthing, sector_t *sec
 						}
 						node->PrevActor = link;
 						*link = node;
+						Level->blockmap.LinkThing(node);
 
 						// Link in to actor
 						node->PrevBlock = alink;
@@ -882,6 +884,58 @@ void FMultiBlockLinesIterator::Reset()
 	startIteratorForGroup(basegroup);
 }
 
+//===========================================================================
+//
+// FBlockmap :: CompactThings
+//
+// Removes the holes left by UnlinkThing without changing the order of
+// the remaining actors.
+//
+//===========================================================================
+
+void FBlockmap::CompactThings(FBlockThings &block)
+{
+	auto &things = block.Things;
+	unsigned count = 0;
+	for (unsigned i = 0; i < things.Size(); i++)
+	{
+		if (things[i].Me != nullptr)
+		{
+			things[count] = things[i];
+			things[count].Node->ThingIndex = count;
+			count++;
+		}
+	}
+	things.Clamp(count);
+	block.Holes = 0;
+}
+
+//===========================================================================
+//
+// FBlockmap :: RebuildThings
+//
+// Recreates a block's thing array from its blocklinks chain, for code
+// that restores the chain directly instead of going through LinkToWorld.
+//
+//===========================================================================
+
+void FBlockmap::RebuildThings(int index)
+{
+	auto &things = blockthings[index].Things;
+	unsigned count = 0;
+	for (FBlockNode *block = blocklinks[index]; block != nullptr; block = block->NextActor)
+	{
+		count++;
+	}
+	things.Resize(count);
+	for (FBlockNode *block = blocklinks[index]; block != nullptr; block = block->NextActor)
+	{
+		block->ThingIndex = --count;
+		things[count] = { block->Me, block };
+	}
+	blockthings[index].Holes = 0;
+}
+
 //===========================================================================
 //
 // FBlockThingsIterator :: FBlockThingsIterator
@@ -895,7 +949,7 @@ FBlockThingsIterator::FBlockThingsIterator(FLevelLocals *l)
 	minx = maxx = 0;
 	miny = maxy = 0;
 	ClearHash();
-	block = NULL;
+	numthings = 0;
 }
 
 FBlockThingsIterator::FBlockThingsIterator(FLevelLocals *l, int _minx, int _miny, int _maxx, int _maxy)
@@ -928,11 +982,56 @@ void FBlockThingsIterator::init(const FBoundingBox &box, bool clearhash)
 
 void FBlockThingsIterator::ClearHash()
 {
-	memset(Buckets, -1, sizeof(Buckets));
+	memset(FixedBuckets, -1, sizeof(FixedBuckets));
+	NumBuckets = countof(FixedBuckets);
 	NumFixedHash = 0;
 	DynHash.Clear();
 }
 
+//===========================================================================
+//
+// FBlockThingsIterator :: GrowHash
+//
+// Every returned actor goes into the hash, so queries over dense areas
+// need more buckets than the fixed ones to keep the chains short.
+//
+//===========================================================================
+
+void FBlockThingsIterator::GrowHash()
+{
+	NumBuckets *= 4;
+	DynBuckets.Resize(NumBuckets);
+	memset(DynBuckets.Data(), -1, NumBuckets * sizeof(int));
+	int count = NumFixedHash + DynHash.Size();
+	for (int i = 0; i < count; i++)
+	{
+		HashEntry *entry = GetHashEntry(i);
+		size_t hash = ((size_t)entry->Actor >> 3) & (NumBuckets - 1);
+		entry->Next = DynBuckets[hash];
+		DynBuckets[hash] = i;
+	}
+}
+
+//===========================================================================
+//
+// FBlockThingsIterator :: IsInBlock
+//
+// Checks if an actor from the current block's copy is still linked into
+// the block. One that moved away in the meantime is no longer part of it,
+// the same as if the iterator had followed the block's chain.
+//
+//===========================================================================
+
+bool FBlockThingsIterator::IsInBlock(AActor *me)
+{
+	int index = cury * Level->blockmap.bmapwidth + curx;
+	for (FBlockNode *node = me->BlockNode; node != nullptr; node = node->NextBlock)
+	{
+		if (node->BlockIndex == index) return true;
+	}
+	return false;
+}
+
 //===========================================================================
 //
 // FBlockThingsIterator :: StartBlock
@@ -945,12 +1044,28 @@ void FBlockThingsIterator::StartBlock(int x, int y)
 	cury = y;
 	if (Level->blockmap.isValidBlock(x, y))
 	{
-		block = Level->blockmap.blocklinks[y*Level->blockmap.bmapwidth + x];
+		// Work on a copy so that actors moving in or out of this block
+		// while the caller processes it cannot upset the iteration.
+		auto &things = Level->blockmap.blockthings[y*Level->blockmap.bmapwidth + x].Things;
+		unsigned size = things.Size();
+		AActor **copy = FixedThings;
+		if (size > countof(FixedThings))
+		{
+			// Resize never shrinks the allocation, so after the first dense block this no longer allocates.
+			DynThings.Resize(size);
+			copy = DynThings.Data();
+		}
+		numthings = 0;
+		for (unsigned i = 0; i < size; i++)
+		{
+			if (things[i].Me != nullptr) copy[numthings++] = things[i].Me;
+		}
+		snapshotsize = size;
 	}
 	else
 	{
 		// invalid block
-		block = NULL;
+		numthings = 0;
 	}
 }
 
@@ -977,20 +1092,17 @@ AActor *FBlockThingsIterator::Next(bool centeronly)
 {
 	for (;;)
 	{
-		while (block != NULL)
+		while (numthings > 0)
 		{
-			AActor *me = block->Me;
-			FBlockNode *mynode = block;
+			AActor *me = GetThings()[--numthings];
 			HashEntry *entry;
 			int i;
 
-			block = block->NextActor;
-			// Don't recheck things that were already checked
-			if (mynode->NextBlock == NULL && mynode->PrevBlock == &me->BlockNode)
-			{ // This actor doesn't span blocks, so we know it can only ever be checked once.
-				return me;
+			if (!IsInBlock(me))
+			{ // This actor has left the block since the block was entered.
+				continue;
 			}
-			if (centeronly)
+			if (centeronly && me->BlockNode->NextBlock != nullptr)
 			{
 				// Block boundaries for compatibility mode
 				double blockleft = (curx * FBlockmap::MAPBLOCKUNITS) + Level->blockmap.bmaporgx;
@@ -999,47 +1111,49 @@ AActor *FBlockThingsIterator::Next(bool centeronly)
 				double blocktop = blockbottom + FBlockmap::MAPBLOCKUNITS;
 
 				// only return actors with the center in this block
-				if (me->X() >= blockleft && me->X() < blockright &&
-					me->Y() >= blockbottom && me->Y() < blocktop)
+				if (!(me->X() >= blockleft && me->X() < blockright &&
+					me->Y() >= blockbottom && me->Y() < blocktop))
 				{
-					return me;
+					continue;
 				}
 			}
+
+			// Don't recheck things that were already checked. This must be done for every actor, not
+			// just those spanning blocks, because the caller may move an actor into a block that comes later.
+			int *buckets = GetBuckets();
+			size_t hash = ((size_t)me >> 3) & (NumBuckets - 1);
+			for (i = buckets[hash]; i >= 0; )
+			{
+				entry = GetHashEntry(i);
+				if (entry->Actor == me)
+				{ // I've already been checked. Skip to the next actor.
+					break;
+				}
+				i = entry->Next;
+			}
+			if (i >= 0) continue;
+
+			// Add me to the hash table and return me.
+			if (NumFixedHash < (int)countof(FixedHash))
+			{
+				i = NumFixedHash++;
+				entry = &FixedHash[i];
+			}
 			else
 			{
-				size_t hash = ((size_t)me >> 3) % countof(Buckets);
-				for (i = Buckets[hash]; i >= 0; )
+				if (DynHash.Size() == 0)
 				{
-					entry = GetHashEntry(i);
-					if (entry->Actor == me)
-					{ // I've already been checked. Skip to the next actor.
-						break;
-					}
-					i = entry->Next;
-				}
-				if (i < 0)
-				{ // Add me to the hash table and return me.
-					if (NumFixedHash < (int)countof(FixedHash))
-					{
-						entry = &FixedHash[NumFixedHash];
-						entry->Next = Buckets[hash];
-						Buckets[hash] = NumFixedHash++;
-					}
-					else
-					{
-						if (DynHash.Size() == 0)
-						{
-							DynHash.Grow(50);
-						}
-						i = DynHash.Reserve(1);
-						entry = &DynHash[i];
-						entry->Next = Buckets[hash];
-						Buckets[hash] = i + countof(FixedHash);
-					}
-					entry->Actor = me;
-					return me;
+					DynHash.Grow(50);
 				}
+				int dyn = DynHash.Reserve(1);
+				entry = &DynHash[dyn];
+				i = dyn + countof(FixedHash);
 			}
+			entry->Actor = me;
+			entry->Next = buckets[hash];
+			buckets[hash] = i;
+			if ((unsigned)i >= NumBuckets * 2) GrowHash();
+			return me;
 		}
 
 		if (++curx > maxx)
@@ -1815,29 +1929,30 @@ static AActor *RoughBlockCheck (AActor *mo, int index, void *param)
 {
 	BlockCheckInfo *info = (BlockCheckInfo *)param;
 
-	FBlockNode *link;
+	auto &things = mo->Level->blockmap.blockthings[index].Things;
 
-	for (link = mo->Level->blockmap.blocklinks[index]; link != NULL; link = link->NextActor)
+	for (int i = things.Size() - 1; i >= 0; i--)
 	{
-		if (link->Me != mo)
+		AActor *link = things[i].Me;
+		if (link != nullptr && link != mo)
 		{
-			if (info->onlyseekable && !mo->CanSeek(link->Me))
+			if (info->onlyseekable && !mo->CanSeek(link))
 			{
 				continue;
 			}
-			if (info->frontonly && P_PointOnDivlineSide(link->Me->X(), link->Me->Y(), &info->frontline) != 0)
+			if (info->frontonly && P_PointOnDivlineSide(link->X(), link->Y(), &info->frontline) != 0)
 			{
 				continue;
 			}
 			// skip actors outside of specified FOV
-			if (info->fov > 0 && !P_CheckFov(mo, link->Me, info->fov))
+			if (info->fov > 0 && !P_CheckFov(mo, link, info->fov))
 			{
 				continue;
 			}
 
-			if (mo->IsOkayToAttack (link->Me))
+			if (mo->IsOkayToAttack (link))
 			{
-				return link->Me;
+				return link;
 			}
 		}
 	}
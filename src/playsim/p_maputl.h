@@ -291,9 +291,19 @@ class FBlockThingsIterator
 
 	int curx, cury;
 
-	FBlockNode *block;
+	// Copy of the current block's actors, consumed from the end.
+	AActor *FixedThings[16];
+	TArray<AActor*> DynThings;
+	unsigned numthings;
+	unsigned snapshotsize;
 
-	int Buckets[32];
+	AActor **GetThings() { return snapshotsize <= countof(FixedThings) ? FixedThings : DynThings.Data(); }
+
+	int FixedBuckets[32];
+	TArray<int> DynBuckets;
+	unsigned NumBuckets;
+
+	int *GetBuckets() { return NumBuckets == countof(FixedBuckets) ? FixedBuckets : DynBuckets.Data(); }
 
 	struct HashEntry
 	{
@@ -309,6 +319,8 @@ class FBlockThingsIterator
 	void StartBlock(int x, int y);
 	void SwitchBlock(int x, int y);
 	void ClearHash();
+	void GrowHash();
+	bool IsInBlock(AActor *me);
 
 	// The following is only for use in the path traverser 
 	// and therefore declared private.
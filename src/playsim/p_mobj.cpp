@@ -102,6 +102,7 @@
 #include "shadowinlines.h"
 #include "model.h"
 #include "d_net.h"
+#include "zoneprofiler.h"
 
 // MACROS ------------------------------------------------------------------
 
@@ -2365,6 +2366,7 @@ bool P_SeekerMissile (AActor *actor, DAngle thresh, DAngle turnMax, bool precise
 
 static double P_XYMovement (AActor *mo, DVector2 scroll) 
 {
+	FProfileZone zone("P_XYMovement");
 	static int pushtime = 0;
 	bool bForceSlide = !scroll.isZero();
 	DVector2 ptry;
@@ -4220,6 +4222,8 @@ DEFINE_ACTION_FUNCTION(AActor, CheckPortalTransition)
 //
 void AActor::Tick ()
 {
+	FProfileZone zone("AActor::Tick");
+
 	// [RH] Data for Heretic/Hexen scrolling sectors
 	static const int8_t HexenCompatSpeeds[] = {-25, 0, -10, -5, 0, 5, 10, 0, 25 };
 	static const int8_t HexenScrollies[24][2] =
@@ -36,6 +36,8 @@
 
 #include "g_levellocals.h"
 #include "actorinlines.h"
+#include "p_benchmark.h"
+#include "ctpl.h"
 
 static FRandom pr_botchecksight ("BotCheckSight");
 static FRandom pr_checksight ("CheckSight");
@@ -51,7 +53,7 @@ This uses specialized forms of the maputils routines for optimized performance
 */
 
 // Performance meters
-static int sightcounts[6];
+static thread_local int sightcounts[6];
 static cycle_t SightCycles;
 static cycle_t MaxSightCycles;
 
@@ -87,8 +89,39 @@ struct SightTask
 };
 
 
-static TArray<intercept_t> intercepts (128);
-static TArray<SightTask> portals(32);
+// Everything a sight check writes to is per thread so that checks can
+// be run in parallel by P_PrefetchSight.
+static thread_local TArray<intercept_t> intercepts (128);
+static thread_local TArray<SightTask> portals(32);
+
+// Per-thread replacement for validcount.
+struct FSightMarks
+{
+	TArray<unsigned> Lines;
+	TArray<unsigned> Polys;
+	unsigned Count = 0;
+
+	void Next(FLevelLocals *Level)
+	{
+		if (Lines.Size() != Level->lines.Size() || Polys.Size() != Level->Polyobjects.Size() || ++Count == 0)
+		{
+			Lines.Resize(Level->lines.Size());
+			Polys.Resize(Level->Polyobjects.Size());
+			if (Lines.Size() > 0) memset(Lines.Data(), 0, Lines.Size() * sizeof(unsigned));
+			if (Polys.Size() > 0) memset(Polys.Data(), 0, Polys.Size() * sizeof(unsigned));
+			Count = 1;
+		}
+	}
+
+	bool Check(unsigned &mark)
+	{
+		if (mark == Count) return false;
+		mark = Count;
+		return true;
+	}
+};
+
+static thread_local FSightMarks sightmarks;
 
 class SightCheck
 {
@@ -434,11 +467,10 @@ bool SightCheck::P_SightCheckLine (line_t *ld)
 {
 	divline_t dl;
 
-	if (ld->validcount == validcount)
+	if (!sightmarks.Check(sightmarks.Lines[ld->Index()]))
 	{
 		return true;
 	}
-	ld->validcount = validcount;
 	if (P_PointOnDivlineSide (ld->v1->fPos(), &Trace) ==
 		P_PointOnDivlineSide (ld->v2->fPos(), &Trace))
 	{
@@ -495,9 +527,8 @@ int SightCheck::P_SightBlockLinesIterator (int x, int y)
 	{
 		if (polyLink->polyobj)
 		{ // only check non-empty links
-			if (polyLink->polyobj->validcount != validcount)
+			if (sightmarks.Check(sightmarks.Polys[unsigned(polyLink->polyobj - Level->Polyobjects.Data())]))
 			{
-				polyLink->polyobj->validcount = validcount;
 				for (i = 0; i < polyLink->polyobj->Linedefs.Size(); i++)
 				{
 					if (!P_SightCheckLine(polyLink->polyobj->Linedefs[i]))
@@ -627,7 +658,7 @@ bool SightCheck::P_SightPathTraverse ()
 	int mapx, mapy, mapxstep, mapystep;
 	int count;
 
-	validcount++;
+	sightmarks.Next(Level);
 	intercepts.Clear ();
 	x1 = sightstart.X + Startfrac * Trace.dx;
 	y1 = sightstart.Y + Startfrac * Trace.dy;
@@ -838,22 +869,67 @@ sightcounts[2]++;
 =====================
 */
 
-int P_CheckSight (AActor *t1, AActor *t2, int flags)
+//==========================================================================
+//
+// Sight cache
+//
+// Monster AI tends to ask for the same pairs over and over in a single
+// tic, so the result of the trace is remembered until either one of the
+// actors moves or the engine changes something that can affect sight
+// (line specials, polyobjects, sector movement, 3D floors, portals).
+// The RNG driven and the actor state dependent rejection checks are
+// always redone.
+//
+// Scripts that write line flags directly are not tracked, so a stale
+// result is possible on such maps. The cache is therefore off by default
+// and stored in the server info so that demos replay with the setting
+// they were recorded with.
+//
+//==========================================================================
+
+CVAR(Bool, sv_sightcache, false, CVAR_SERVERINFO)
+
+struct FSightCacheEntry
 {
-	SightCycles.Clock();
+	AActor *t1, *t2;
+	DVector3 pos1, pos2;
+	double height1, height2;
+	unsigned stamp;
+	int flags;
+	bool result;
+};
 
-	bool res;
+enum { SIGHTCACHE_SIZE = 4096 };
 
-	if (t1 == nullptr || t2 == nullptr)
-	{
-		return false;
-	}
+static FSightCacheEntry SightCache[SIGHTCACHE_SIZE];
+static unsigned SightCacheStamp = 1;
+static int sightcachehits;
 
-	if ((t2->flags8 & MF8_MVISBLOCKED) && !(flags & SF_IGNOREVISIBILITY))
-	{
-		return false;
-	}
+void P_InvalidateSightCache()
+{
+	SightCacheStamp++;
+}
+
+static FSightCacheEntry *P_FindSightCacheEntry(AActor *t1, AActor *t2, int flags, bool &found)
+{
+	size_t hash = (((size_t)t1 >> 4) * 31 + ((size_t)t2 >> 4) + flags) & (SIGHTCACHE_SIZE - 1);
+	auto entry = &SightCache[hash];
+	found = entry->stamp == SightCacheStamp && entry->t1 == t1 && entry->t2 == t2 && entry->flags == flags &&
+		entry->pos1 == t1->Pos() && entry->pos2 == t2->Pos() && entry->height1 == t1->Height && entry->height2 == t2->Height;
+	return entry;
+}
+
+//==========================================================================
+//
+// P_SightRejectChecks
+//
+// Everything that can rule out sight without tracing a line.
+// Returns false if t1 cannot possibly see t2.
+//
+//==========================================================================
 
+static bool P_SightRejectChecks(AActor *t1, AActor *t2, int flags)
+{
 	auto s1 = t1->Sector;
 	auto s2 = t2->Sector;
 	//
@@ -862,8 +938,7 @@ int P_CheckSight (AActor *t1, AActor *t2, int flags)
 	if (!t1->Level->CheckReject(s1, s2))
 	{
 sightcounts[0]++;
-		res = false;			// can't possibly be connected
-		goto done;
+		return false;			// can't possibly be connected
 	}
 
 //
@@ -878,8 +953,7 @@ sightcounts[0]++;
 	{ // small chance of an attack being made anyway
 		if ((t1->Level->BotInfo.m_Thinking ? pr_botchecksight() : pr_checksight()) > 50)
 		{
-			res = false;
-			goto done;
+			return false;
 		}
 	}
 
@@ -899,56 +973,244 @@ sightcounts[0]++;
 			  (t2->Z() >= s2->heightsec->ceilingplane.ZatPoint(t2) &&
 			   t1->Top() <= s2->heightsec->ceilingplane.ZatPoint(t1)))))
 		{
-			res = false;
-			goto done;
+			return false;
 		}
 	}
+	return true;
+}
 
-	// An unobstructed LOS is possible.
-	// Now look from eyes of t1 to any part of t2.
+//==========================================================================
+//
+// P_SightTrace
+//
+// Looks from the eyes of t1 to any part of t2. 'sec' is the sector
+// at t1's eye height, as returned by GetPortalTransition.
+//
+//==========================================================================
 
-	validcount++;
+static bool P_SightTraceUncached(AActor *t1, AActor *t2, sector_t *sec, double lookheight, int flags)
+{
 	portals.Clear();
+
+	double bottomslope = t2->Z() - lookheight;
+	double topslope = bottomslope + t2->Height;
+	SightTask task = { 0, topslope, bottomslope, -1, sec->PortalGroup };
+
+	SightCheck s(t1->Level);
+	s.init(t1, t2, sec, &task, flags);
+	bool res = s.P_SightPathTraverse ();
+	if (!res)
+	{
+		double dist = t1->Distance2D(t2);
+		for (unsigned i = 0; i < portals.Size(); i++)
+		{
+			portals[i].Frac += 1 / dist;
+			s.init(t1, t2, NULL, &portals[i], flags);
+			if (s.P_SightPathTraverse())
+			{
+				res = true;
+				break;
+			}
+		}
+	}
+	return res;
+}
+
+static bool P_SightTrace(AActor *t1, AActor *t2, sector_t *sec, double lookheight, int flags)
+{
+	FSightCacheEntry *entry = nullptr;
+	if (sv_sightcache)
+	{
+		bool found;
+		entry = P_FindSightCacheEntry(t1, t2, flags, found);
+		if (found)
+		{
+			sightcachehits++;
+			return entry->result;
+		}
+	}
+
+	bool res = P_SightTraceUncached(t1, t2, sec, lookheight, flags);
+	if (entry != nullptr)
+	{
+		*entry = { t1, t2, t1->Pos(), t2->Pos(), t1->Height, t2->Height, SightCacheStamp, flags, res };
+	}
+	return res;
+}
+
+/*
+=====================
+=
+= P_CheckSight
+=
+= Returns true if a straight line between t1 and t2 is unobstructed
+= look from eyes of t1 to any part of t2
+=
+= killough 4/20/98: cleaned up, made to use new LOS struct
+=
+=====================
+*/
+
+int P_CheckSight (AActor *t1, AActor *t2, int flags)
+{
+	FBenchScope bench(BENCH_Sight);
+
+	if (t1 == nullptr || t2 == nullptr)
+	{
+		return false;
+	}
+
+	if ((t2->flags8 & MF8_MVISBLOCKED) && !(flags & SF_IGNOREVISIBILITY))
+	{
+		return false;
+	}
+
+	SightCycles.Clock();
+
+	bool res = P_SightRejectChecks(t1, t2, flags);
+	if (res)
 	{
+		// An unobstructed LOS is possible.
 		sector_t *sec;
 		double lookheight = t1->Z() + t1->Height*0.75;
 		t1->GetPortalTransition(lookheight, &sec);
+		res = P_SightTrace(t1, t2, sec, lookheight, flags);
+	}
+
+	SightCycles.Unclock();
+	return res;
+}
+
+//==========================================================================
+//
+// P_PrefetchSight
+//
+// Called right before the actor thinkers run. Collects the sight checks
+// the monster AI is most likely to make this tic (monsters checking on
+// their target or looking for players), traces them on worker threads
+// and stores the results in the sight cache. Tracing only reads the
+// level and the results are stored in a fixed order, so this can never
+// change the outcome of a game. When an actor moves before its check is
+// made, the prefetched result is simply not used.
+//
+//==========================================================================
+
+CVAR(Int, p_sightthreads, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+struct FSightPrefetch
+{
+	AActor *t1, *t2;
+	int flags;
+	bool result;
+};
+
+static TArray<FSightPrefetch> SightPrefetch;
+static ctpl::thread_pool SightPool;
 
-		double bottomslope = t2->Z() - lookheight;
-		double topslope = bottomslope + t2->Height;
-		SightTask task = { 0, topslope, bottomslope, -1, sec->PortalGroup };
+static void P_AddSightPrefetch(AActor *t1, AActor *t2, int flags)
+{
+	if (t2->Level != t1->Level || ((t2->flags8 & MF8_MVISBLOCKED) && !(flags & SF_IGNOREVISIBILITY)))
+	{
+		return;
+	}
+	if (!t1->Level->CheckReject(t1->Sector, t2->Sector))
+	{
+		return;
+	}
+	bool found;
+	P_FindSightCacheEntry(t1, t2, flags, found);
+	if (!found)
+	{
+		SightPrefetch.Push({ t1, t2, flags, false });
+	}
+}
 
+static void P_RunSightPrefetch(unsigned start, unsigned end)
+{
+	for (unsigned i = start; i < end; i++)
+	{
+		auto &query = SightPrefetch[i];
+		sector_t *sec;
+		double lookheight = query.t1->Z() + query.t1->Height*0.75;
+		query.t1->GetPortalTransition(lookheight, &sec);
+		query.result = P_SightTraceUncached(query.t1, query.t2, sec, lookheight, query.flags);
+	}
+}
+
+void P_PrefetchSight(FLevelLocals *Level)
+{
+	int threads = min<int>(p_sightthreads, 64);
+	if (threads <= 0 || !sv_sightcache)
+	{
+		return;
+	}
 
-		SightCheck s(t1->Level);
-		s.init(t1, t2, sec, &task, flags);
-		res = s.P_SightPathTraverse ();
-		if (!res)
+	SightPrefetch.Clear();
+	auto it = Level->GetThinkerIterator<AActor>(NAME_None, STAT_DEFAULT);
+	AActor *ac;
+	while ((ac = it.Next()))
+	{
+		if (!(ac->flags3 & MF3_ISMONSTER) || ac->health <= 0 || (ac->flags2 & MF2_DORMANT))
+		{
+			continue;
+		}
+		if (ac->target != nullptr)
+		{
+			// A_Chase and P_CheckMissileRange
+			P_AddSightPrefetch(ac, ac->target, SF_SEEPASTBLOCKEVERYTHING);
+		}
+		else if (!(ac->flags & MF_FRIENDLY))
 		{
-			double dist = t1->Distance2D(t2);
-			for (unsigned i = 0; i < portals.Size(); i++)
+			// P_LookForPlayers
+			for (int i = 0; i < MAXPLAYERS; i++)
 			{
-				portals[i].Frac += 1 / dist;
-				s.init(t1, t2, NULL, &portals[i], flags);
-				if (s.P_SightPathTraverse())
+				if (Level->PlayerInGame(i) && Level->Players[i]->mo != nullptr)
 				{
-					res = true;
-					break;
+					P_AddSightPrefetch(ac, Level->Players[i]->mo, SF_SEEPASTSHOOTABLELINES);
 				}
 			}
 		}
 	}
 
-done:
+	// Not worth waking up the workers for a handful of checks.
+	unsigned count = SightPrefetch.Size();
+	if (count < 64)
+	{
+		return;
+	}
+
+	SightCycles.Clock();
+	if (SightPool.size() != threads)
+	{
+		SightPool.resize(threads);
+	}
+	unsigned chunks = threads + 1;
+	std::vector<std::future<void>> futures;
+	for (unsigned i = 1; i < chunks; i++)
+	{
+		futures.push_back(SightPool.push([=](int) { P_RunSightPrefetch(count * i / chunks, count * (i + 1) / chunks); }));
+	}
+	P_RunSightPrefetch(0, count / chunks);
+	for (auto &future : futures)
+	{
+		future.wait();
+	}
+
+	for (auto &query : SightPrefetch)
+	{
+		bool found;
+		auto entry = P_FindSightCacheEntry(query.t1, query.t2, query.flags, found);
+		*entry = { query.t1, query.t2, query.t1->Pos(), query.t2->Pos(), query.t1->Height, query.t2->Height, SightCacheStamp, query.flags, query.result };
+	}
 	SightCycles.Unclock();
-	return res;
 }
 
 ADD_STAT (sight)
 {
 	FString out;
-	out.Format ("%04.1f ms (%04.1f max), %5d %2d%4d%4d%4d%4d\n",
+	out.Format ("%04.1f ms (%04.1f max), %5d %2d%4d%4d%4d%4d, %5d cached\n",
 		SightCycles.TimeMS(), MaxSightCycles.TimeMS(),
-		sightcounts[3], sightcounts[0], sightcounts[1], sightcounts[2], sightcounts[4], sightcounts[5]);
+		sightcounts[3], sightcounts[0], sightcounts[1], sightcounts[2], sightcounts[4], sightcounts[5], sightcachehits);
 	return out;
 }
 
@@ -964,4 +1226,5 @@ void P_ResetSightCounters (bool full)
 	}
 	SightCycles.Reset();
 	memset (sightcounts, 0, sizeof(sightcounts));
+	sightcachehits = 0;
 }
@@ -369,6 +369,7 @@ bool FLevelLocals::ChangePortalLine(line_t *line, int destid)
 		port->mFlags = port->mDefFlags;
 	}
 	SetPortalRotation(port);
+	P_InvalidateSightCache();
 	return true;
 }
 
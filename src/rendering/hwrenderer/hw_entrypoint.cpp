@@ -199,6 +199,8 @@ sector_t* RenderViewpoint(FRenderViewpoint& mainvp, AActor* camera, IntRect* bou
 	return mainvp.sector;
 }
 
+FPNGImage* SavePicCapture;
+
 void DoWriteSavePic(FileWriter* file, ESSType ssformat, uint8_t* scr, int width, int height, sector_t* viewsector, bool upsidedown)
 {
 	PalEntry palette[256];
@@ -246,6 +248,24 @@ void DoWriteSavePic(FileWriter* file, ESSType ssformat, uint8_t* scr, int width,
 		pitch *= -1;
 	}
 
+	if (SavePicCapture != nullptr)
+	{
+		auto& image = *SavePicCapture;
+		int rowsize = width * pixelsize;
+		image.Pixels.Resize(rowsize * height);
+		for (int y = 0; y < height; y++)
+		{
+			memcpy(&image.Pixels[y * rowsize], scr + y * pitch, rowsize);
+		}
+		memcpy(image.Palette, palette, sizeof(palette));
+		image.ColorType = ssformat;
+		image.Width = width;
+		image.Height = height;
+		image.Pitch = rowsize;
+		image.Gamma = vid_gamma;
+		return;
+	}
+
 	M_CreatePNG(file, scr, ssformat == SS_PAL ? palette : nullptr, ssformat, width, height, pitch, vid_gamma);
 }
 
@@ -43,6 +43,7 @@
 #include "flatvertices.h"
 #include "hw_vertexbuilder.h"
 #include "hw_walldispatcher.h"
+#include "zoneprofiler.h"
 
 #include "p_visualthinker.h"
 
@@ -77,13 +78,14 @@ struct RenderJob
 	{
 		FlatJob,
 		WallJob,
-		SpriteJob,
+		ThingJob,
+		PortalThingsJob,
 		ParticleJob,
 		PortalJob,
-		TerminateJob	// inserted when all work is done so that the worker can return.
 	};
 	
 	int type;
+	area_t area;
 	subsector_t *sub;
 	seg_t *seg;
 };
@@ -94,79 +96,136 @@ class RenderJobQueue
 	RenderJob pool[300000];	// Way more than ever needed. The largest ever seen on a single viewpoint is around 40000.
 	std::atomic<int> readindex{};
 	std::atomic<int> writeindex{};
+	std::atomic<bool> finished{};
 public:
-	void AddJob(int type, subsector_t *sub, seg_t *seg = nullptr)
+	void AddJob(int type, area_t area, subsector_t *sub, seg_t *seg = nullptr)
 	{
 		// This does not check for array overflows. The pool should be large enough that it never hits the limit.
 
-		pool[writeindex] = { type, sub, seg };
+		pool[writeindex] = { type, area, sub, seg };
 		writeindex++;	// update index only after the value has been written.
 	}
 
-	RenderJob *GetJob()
+	RenderJob *GetJob(int &index)
 	{
-		if (readindex < writeindex) return &pool[readindex++];
+		// Multiple workers may be competing for the same job.
+		int read = readindex;
+		while (read < writeindex)
+		{
+			if (readindex.compare_exchange_weak(read, read + 1))
+			{
+				index = read;
+				return &pool[read];
+			}
+		}
 		return nullptr;
 	}
+
+	// Called by the main thread when everything has been queued.
+	void Finish()
+	{
+		finished = true;
+	}
+
+	bool IsFinished()
+	{
+		return finished;
+	}
 	
 	void ReleaseAll()
 	{
 		readindex = 0;
 		writeindex = 0;
+		finished = false;
 	}
 };
 
 static RenderJobQueue jobQueue;	// One static queue is sufficient here. This code will never be called recursively.
 
-void HWDrawInfo::WorkerThread()
+//==========================================================================
+//
+// Number of worker threads for the BSP jobs. By default this leaves
+// enough cores alone for the main thread and the rest of the system
+// because idle workers keep spinning until the traversal is done.
+//
+//==========================================================================
+
+CVAR(Int, gl_multithread_workers, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+static int GetBspWorkerCount()
 {
+	if (gl_multithread_workers > 0) return min<int>(gl_multithread_workers, MAX_BSP_WORKERS);
+	return clamp<int>(std::thread::hardware_concurrency() / 4, 1, 4);
+}
+
+void HWDrawInfo::WorkerThread(int index)
+{
+	FProfileZone zone("RenderBSP worker");
 	sector_t *front, *back;
 	HWWallDispatcher disp(this);
 
-	WTTotal.Clock();
+	// Each worker has its own timers and counters. MergeWorkerOutput adds them to the global ones.
+	bspWorkerOutput = &BspWorkerOutputs[index];
+	glcycle_t &wttotal = bspWorkerOutput->Total;
+	glcycle_t &setupwall = bspWorkerOutput->SetupWall;
+	glcycle_t &setupflat = bspWorkerOutput->SetupFlat;
+	glcycle_t &setupsprite = bspWorkerOutput->SetupSprite;
+
+	wttotal.Clock();
 	isWorkerThread = true;	// for adding asserts in GL API code. The worker thread may never call any GL API.
 	while (true)
 	{
-		auto job = jobQueue.GetJob();
+		int jobindex;
+		auto job = jobQueue.GetJob(jobindex);
 		if (job == nullptr)
 		{
+			// Once the main thread is done the queue needs to be checked one last time because a job may have been added right before.
+			if (jobQueue.IsFinished())
+			{
+				job = jobQueue.GetJob(jobindex);
+				if (job == nullptr) break;
+			}
+			else
+			{
 #ifdef ARCH_IA32
-			// The queue is empty. But yielding would be too costly here and possibly cause further delays down the line if the thread is halted.
-			// So instead add a few pause instructions and retry immediately.
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
-			_mm_pause();
+				// The queue is empty. But yielding would be too costly here and possibly cause further delays down the line if the thread is halted.
+				// So instead add a few pause instructions and retry immediately.
+				_mm_pause();
+				_mm_pause();
+				_mm_pause();
+				_mm_pause();
+				_mm_pause();
+				_mm_pause();
+				_mm_pause();
+				_mm_pause();
+				_mm_pause();
+				_mm_pause();
 #endif // ARCH_IA32
+				continue;
+			}
 		}
+
+		bspWorkerOutput->Job = jobindex;
+		bspWorkerOutput->Area = job->area;
+
 		// Note that the main thread MUST have prepared the fake sectors that get used below!
 		// This worker thread cannot prepare them itself without costly synchronization.
-		else switch (job->type)
+		switch (job->type)
 		{
-		case RenderJob::TerminateJob:
-			WTTotal.Unclock();
-			return;
-
 		case RenderJob::WallJob:
 		{
 			HWWall wall;
-			SetupWall.Clock();
+			setupwall.Clock();
 			wall.sub = job->sub;
 
-			front = hw_FakeFlat(job->sub->sector, in_area, false);
+			front = hw_FakeFlat(job->sub->sector, job->area, false);
 			auto seg = job->seg;
 			auto backsector = seg->backsector;
 			if (!backsector && seg->linedef->isVisualPortal() && seg->sidedef == seg->linedef->sidedef[0]) // For one-sided portals use the portal's destination sector as backsector.
 			{
 				auto portal = seg->linedef->getPortal();
 				backsector = portal->mDestination->frontsector;
-				back = hw_FakeFlat(backsector, in_area, true);
+				back = hw_FakeFlat(backsector, job->area, true);
 				if (front->floorplane.isSlope() || front->ceilingplane.isSlope() || back->floorplane.isSlope() || back->ceilingplane.isSlope())
 				{
 					// Having a one-sided portal like this with slopes is too messy so let's ignore that case.
@@ -181,48 +240,141 @@ void HWDrawInfo::WorkerThread()
 				}
 				else
 				{
-					back = hw_FakeFlat(backsector, in_area, true);
+					back = hw_FakeFlat(backsector, job->area, true);
 				}
 			}
 			else back = nullptr;
 
 			wall.Process(&disp, job->seg, front, back);
-			rendered_lines++;
-			SetupWall.Unclock();
+			bspWorkerOutput->RenderedLines++;
+			setupwall.Unclock();
 			break;
 		}
 
 		case RenderJob::FlatJob:
 		{
 			HWFlat flat;
-			SetupFlat.Clock();
+			setupflat.Clock();
 			flat.section = job->sub->section;
-			front = hw_FakeFlat(job->sub->render_sector, in_area, false);
+			front = hw_FakeFlat(job->sub->render_sector, job->area, false);
 			flat.ProcessSector(this, front);
-			SetupFlat.Unclock();
+			setupflat.Unclock();
 			break;
 		}
 
-		case RenderJob::SpriteJob:
-			SetupSprite.Clock();
-			front = hw_FakeFlat(job->sub->sector, in_area, false);
-			RenderThings(job->sub, front);
-			SetupSprite.Unclock();
+		case RenderJob::ThingJob:
+			setupsprite.Clock();
+			front = hw_FakeFlat(job->sub->sector, job->area, false);
+			RenderThing((AActor *)job->seg, front, job->area);
+			setupsprite.Unclock();
+			break;
+
+		case RenderJob::PortalThingsJob:
+			setupsprite.Clock();
+			front = hw_FakeFlat(job->sub->sector, job->area, false);
+			RenderPortalThings(job->sub, front, job->area);
+			setupsprite.Unclock();
 			break;
 
 		case RenderJob::ParticleJob:
-			SetupSprite.Clock();
-			front = hw_FakeFlat(job->sub->sector, in_area, false);
+			setupsprite.Clock();
+			front = hw_FakeFlat(job->sub->sector, job->area, false);
 			RenderParticles(job->sub, front);
-			SetupSprite.Unclock();
+			setupsprite.Unclock();
 			break;
 
 		case RenderJob::PortalJob:
 			AddSubsectorToPortal((FSectorPortalGroup *)job->seg, job->sub);
 			break;
 		}
+	}
+	bspWorkerOutput = nullptr;
+	wttotal.Unclock();
+}
+
+//==========================================================================
+//
+// Puts everything the workers produced into the draw lists, in the
+// order the jobs were queued. All events of one job come from the
+// same worker and each worker's events are sorted by job already.
+//
+//==========================================================================
+
+void HWDrawInfo::MergeWorkerOutput(int numworkers)
+{
+	unsigned pos[MAX_BSP_WORKERS] = {};
+	HWWallDispatcher disp(this);
+	auto savedarea = in_area;
 
+	for (int i = 0; i < numworkers; i++)
+	{
+		auto &output = BspWorkerOutputs[i];
+		rendered_lines += output.RenderedLines;
+		rendered_flats += output.RenderedFlats;
+		rendered_sprites += output.RenderedSprites;
+		WTTotal += output.Total;
+		SetupWall += output.SetupWall;
+		SetupFlat += output.SetupFlat;
+		SetupSprite += output.SetupSprite;
 	}
+
+	while (true)
+	{
+		int worker = -1;
+		for (int i = 0; i < numworkers; i++)
+		{
+			auto &events = BspWorkerOutputs[i].Events;
+			if (pos[i] < events.Size() && (worker < 0 || events[pos[i]].job < BspWorkerOutputs[worker].Events[pos[worker]].job))
+			{
+				worker = i;
+			}
+		}
+		if (worker < 0) break;
+
+		auto &events = BspWorkerOutputs[worker].Events;
+		int job = events[pos[worker]].job;
+		for (; pos[worker] < events.Size() && events[pos[worker]].job == job; pos[worker]++)
+		{
+			auto &ev = events[pos[worker]];
+			switch (ev.type)
+			{
+			case HWBspEvent::Wall:
+				drawlists[ev.list].PushWall((HWWall *)ev.item);
+				break;
+
+			case HWBspEvent::Flat:
+				drawlists[ev.list].PushFlat((HWFlat *)ev.item);
+				break;
+
+			case HWBspEvent::Sprite:
+				drawlists[ev.list].PushSprite((HWSprite *)ev.item);
+				break;
+
+			case HWBspEvent::Decal:
+				Decals[ev.list].Push((HWDecal *)ev.item);
+				break;
+
+			case HWBspEvent::Portal:
+				// line to line portals process actors in the current area.
+				in_area = ev.area;
+				((HWWall *)ev.item)->PutPortal(&disp, ev.list, ev.plane);
+				break;
+
+			case HWBspEvent::UpperMissing:
+				AddUpperMissingTexture((side_t *)ev.item, (subsector_t *)ev.item2, ev.height);
+				break;
+
+			case HWBspEvent::LowerMissing:
+				AddLowerMissingTexture((side_t *)ev.item, (subsector_t *)ev.item2, ev.height);
+				break;
+
+			case HWBspEvent::SubsectorPortal:
+				AddSubsectorToPortal((FSectorPortalGroup *)ev.item, (subsector_t *)ev.item2);
+				break;
+			}
+		}
+	}
+	in_area = savedarea;
 }
 
 
@@ -406,7 +558,7 @@ void HWDrawInfo::AddLine (seg_t *seg, bool portalclip)
 		{
 			if (multithread)
 			{
-				jobQueue.AddJob(RenderJob::WallJob, seg->Subsector, seg);
+				jobQueue.AddJob(RenderJob::WallJob, in_area, seg->Subsector, seg);
 			}
 			else
 			{
@@ -587,45 +739,55 @@ void HWDrawInfo::RenderThings(subsector_t * sub, sector_t * sector)
 {
 	sector_t * sec=sub->sector;
 	// Handle all things in sector.
-	const auto &vp = Viewpoint;
 	for (auto p = sec->touching_renderthings; p != nullptr; p = p->m_snext)
 	{
 		auto thing = p->m_thing;
 		if (thing->validcount == validcount) continue;
 		thing->validcount = validcount;
+		RenderThing(thing, sector, in_area);
+	}
+	RenderPortalThings(sub, sector, in_area);
+}
 
-		if(Viewpoint.IsAllowedOoB() && thing->Sector->isSecret() && thing->Sector->wasSecret() && !r_radarclipper) continue; // This covers things that are touching non-secret sectors
-		FIntCVar *cvar = thing->GetInfo()->distancecheck;
-		if (cvar != nullptr && *cvar >= 0)
+void HWDrawInfo::RenderThing(AActor *thing, sector_t * sector, area_t area)
+{
+	const auto &vp = Viewpoint;
+
+	if(Viewpoint.IsAllowedOoB() && thing->Sector->isSecret() && thing->Sector->wasSecret() && !r_radarclipper) return; // This covers things that are touching non-secret sectors
+	FIntCVar *cvar = thing->GetInfo()->distancecheck;
+	if (cvar != nullptr && *cvar >= 0)
+	{
+		double dist = (thing->Pos() - vp.Pos).LengthSquared();
+		double check = (double)**cvar;
+		if (dist >= check * check)
 		{
-			double dist = (thing->Pos() - vp.Pos).LengthSquared();
-			double check = (double)**cvar;
-			if (dist >= check * check)
-			{
-				continue;
-			}
+			return;
 		}
-		// If this thing is in a map section that's not in view it can't possibly be visible
-		if (CurrentMapSections[thing->subsector->mapsection])
-		{
-			HWSprite sprite;
+	}
+	// If this thing is in a map section that's not in view it can't possibly be visible
+	if (CurrentMapSections[thing->subsector->mapsection])
+	{
+		HWSprite sprite;
 
-			// [Nash] draw sprite shadow
-			if (R_ShouldDrawSpriteShadow(thing))
+		// [Nash] draw sprite shadow
+		if (R_ShouldDrawSpriteShadow(thing))
+		{
+			double dist = (thing->Pos() - vp.Pos).LengthSquared();
+			double check = r_actorspriteshadowdist;
+			if (dist <= check * check)
 			{
-				double dist = (thing->Pos() - vp.Pos).LengthSquared();
-				double check = r_actorspriteshadowdist;
-				if (dist <= check * check)
-				{
-					sprite.Process(this, thing, sector, in_area, false, true);
-				}
+				sprite.Process(this, thing, sector, area, false, true);
 			}
-
-			sprite.Process(this, thing, sector, in_area, false);
 		}
+
+		sprite.Process(this, thing, sector, area, false);
 	}
-	
-	for (msecnode_t *node = sec->sectorportal_thinglist; node; node = node->m_snext)
+}
+
+void HWDrawInfo::RenderPortalThings(subsector_t * sub, sector_t * sector, area_t area)
+{
+	const auto &vp = Viewpoint;
+	for (msecnode_t *node = sub->sector->sectorportal_thinglist; node; node = node->m_snext)
 	{
 		AActor *thing = node->m_thing;
 		FIntCVar *cvar = thing->GetInfo()->distancecheck;
@@ -648,17 +810,16 @@ void HWDrawInfo::RenderThings(subsector_t * sub, sector_t * sector)
 			double check = r_actorspriteshadowdist;
 			if (dist <= check * check)
 			{
-				sprite.Process(this, thing, sector, in_area, true, true);
+				sprite.Process(this, thing, sector, area, true, true);
 			}
 		}
 
-		sprite.Process(this, thing, sector, in_area, true);
+		sprite.Process(this, thing, sector, area, true);
 	}
 }
 
 void HWDrawInfo::RenderParticles(subsector_t *sub, sector_t *front)
 {
-	SetupSprite.Clock();
 	for (uint32_t i = 0; i < sub->sprites.Size(); i++)
 	{
 		DVisualThinker *sp = sub->sprites[i];
@@ -684,7 +845,6 @@ void HWDrawInfo::RenderParticles(subsector_t *sub, sector_t *front)
 		HWSprite sprite;
 		sprite.ProcessParticle(this, &Level->Particles[i], front, nullptr);
 	}
-	SetupSprite.Unclock();
 }
 
 
@@ -800,7 +960,7 @@ void HWDrawInfo::DoSubsector(subsector_t * sub)
 	{
 		if (multithread)
 		{
-			jobQueue.AddJob(RenderJob::ParticleJob, sub, nullptr);
+			jobQueue.AddJob(RenderJob::ParticleJob, in_area, sub, nullptr);
 		}
 		else
 		{
@@ -826,7 +986,18 @@ void HWDrawInfo::DoSubsector(subsector_t * sub)
 		{
 			if (multithread)
 			{
-				jobQueue.AddJob(RenderJob::SpriteJob, sub, nullptr);
+				// Things get claimed here, otherwise two workers might pick up the same one through different sectors.
+				for (auto p = sector->touching_renderthings; p != nullptr; p = p->m_snext)
+				{
+					auto thing = p->m_thing;
+					if (thing->validcount == validcount) continue;
+					thing->validcount = validcount;
+					jobQueue.AddJob(RenderJob::ThingJob, in_area, sub, (seg_t *)thing);
+				}
+				if (sector->sectorportal_thinglist)
+				{
+					jobQueue.AddJob(RenderJob::PortalThingsJob, in_area, sub);
+				}
 			}
 			else
 			{
@@ -877,7 +1048,7 @@ void HWDrawInfo::DoSubsector(subsector_t * sub)
 
 					if (multithread)
 					{
-						jobQueue.AddJob(RenderJob::FlatJob, sub);
+						jobQueue.AddJob(RenderJob::FlatJob, in_area, sub);
 					}
 					else
 					{
@@ -906,7 +1077,7 @@ void HWDrawInfo::DoSubsector(subsector_t * sub)
 				{
 					if (multithread)
 					{
-						jobQueue.AddJob(RenderJob::PortalJob, sub, (seg_t *)portal);
+						jobQueue.AddJob(RenderJob::PortalJob, in_area, sub, (seg_t *)portal);
 					}
 					else
 					{
@@ -919,7 +1090,7 @@ void HWDrawInfo::DoSubsector(subsector_t * sub)
 				{
 					if (multithread)
 					{
-						jobQueue.AddJob(RenderJob::PortalJob, sub, (seg_t *)portal);
+						jobQueue.AddJob(RenderJob::PortalJob, in_area, sub, (seg_t *)portal);
 					}
 					else
 					{
@@ -1006,6 +1177,7 @@ void HWDrawInfo::RenderOrthoNoFog()
 
 void HWDrawInfo::RenderBSP(void *node, bool drawpsprites)
 {
+	FProfileZone zone("RenderBSP");
 	ClearDitherTargets();
 	Bsp.Clock();
 
@@ -1031,18 +1203,30 @@ void HWDrawInfo::RenderBSP(void *node, bool drawpsprites)
 	multithread = gl_multithread;
 	if (multithread)
 	{
+		int numworkers = GetBspWorkerCount();
+		if (renderPool.size() < numworkers) renderPool.resize(numworkers);
+
 		jobQueue.ReleaseAll();
-		auto future = renderPool.push([&](int id) {
-			WorkerThread();
-		});
+		std::future<void> futures[MAX_BSP_WORKERS];
+		for (int i = 0; i < numworkers; i++)
+		{
+			BspWorkerOutputs[i].Events.Clear();
+			BspWorkerOutputs[i].ResetStats();
+			futures[i] = renderPool.push([this, i](int id) {
+				WorkerThread(i);
+			});
+		}
 		if (Viewpoint.IsOrtho() && ((Level->flags3 & LEVEL3_NOFOGOFWAR) || !r_radarclipper)) RenderOrthoNoFog();
 		else RenderBSPNode(node);
 
-		jobQueue.AddJob(RenderJob::TerminateJob, nullptr, nullptr);
+		jobQueue.Finish();
 		Bsp.Unclock();
 		MTWait.Clock();
-		future.wait();
+		for (int i = 0; i < numworkers; i++) futures[i].wait();
 		MTWait.Unclock();
+		Bsp.Clock();
+		MergeWorkerOutput(numworkers);
+		Bsp.Unclock();
 	}
 	else
 	{
@@ -441,6 +441,10 @@ HWPortal * HWDrawInfo::FindPortal(const void * src)
 
 HWDecal *HWDrawInfo::AddDecal(bool onmirror)
 {
+	if (bspWorkerOutput)
+	{
+		return (HWDecal*)bspWorkerOutput->NewItem(HWBspEvent::Decal, onmirror ? 1 : 0, sizeof(HWDecal));
+	}
 	auto decal = (HWDecal*)RenderDataAllocator.Alloc(sizeof(HWDecal));
 	Decals[onmirror ? 1 : 0].Push(decal);
 	return decal;
@@ -982,6 +986,11 @@ void HWDrawInfo::ProcessScene(bool toscreen)
 
 void HWDrawInfo::AddSubsectorToPortal(FSectorPortalGroup *ptg, subsector_t *sub)
 {
+	if (bspWorkerOutput)
+	{
+		bspWorkerOutput->AddEvent(HWBspEvent::SubsectorPortal, 0, -1, 0, ptg, sub);
+		return;
+	}
 	auto portal = FindPortal(ptg);
 	if (!portal)
 	{
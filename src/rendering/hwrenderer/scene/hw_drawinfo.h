@@ -193,7 +193,8 @@ private:
 	subsector_t *currentsubsector;	// used by the line processing code.
 	sector_t *currentsector;
 
-	void WorkerThread();
+	void WorkerThread(int index);
+	void MergeWorkerOutput(int numworkers);
 
 	void UnclipSubsector(subsector_t *sub);
 	
@@ -205,6 +206,8 @@ private:
 	void AddSpecialPortalLines(subsector_t * sub, sector_t * sector, linebase_t *line);
 	public:
 	void RenderThings(subsector_t * sub, sector_t * sector);
+	void RenderThing(AActor *thing, sector_t * sector, area_t area);
+	void RenderPortalThings(subsector_t * sub, sector_t * sector, area_t area);
 	void RenderParticles(subsector_t *sub, sector_t *front);
 	void DoSubsector(subsector_t * sub);
 	int SetupLightsForOtherPlane(subsector_t * sub, FDynLightData &lightdata, const secplane_t *plane);
@@ -328,6 +331,8 @@ public:
 void CleanSWDrawer();
 sector_t* RenderViewpoint(FRenderViewpoint& mainvp, AActor* camera, IntRect* bounds, float fov, float ratio, float fovratio, bool mainview, bool toscreen);
 void WriteSavePic(player_t* player, FileWriter* file, int width, int height);
+// If set, WriteSavePic stores the unencoded image here instead of writing a PNG to the file.
+extern struct FPNGImage* SavePicCapture;
 sector_t* RenderView(player_t* player);
 
 
@@ -40,10 +40,13 @@
 #include "hw_walldispatcher.h"
 
 FMemArena RenderDataAllocator(1024*1024);	// Use large blocks to reduce allocation time.
+HWBspWorkerOutput BspWorkerOutputs[MAX_BSP_WORKERS];
+thread_local HWBspWorkerOutput *bspWorkerOutput;
 
 void ResetRenderDataAllocator()
 {
 	RenderDataAllocator.FreeAll();
+	for (auto &output : BspWorkerOutputs) output.Allocator.FreeAll();
 }
 
 //==========================================================================
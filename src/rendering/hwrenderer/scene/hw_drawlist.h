@@ -1,6 +1,7 @@
 #pragma once
 
 #include "memarena.h"
+#include "stats.h"
 
 extern FMemArena RenderDataAllocator;
 void ResetRenderDataAllocator();
@@ -9,6 +10,84 @@ class HWWall;
 class HWFlat;
 class HWSprite;
 class FRenderState;
+enum area_t : int;
+
+//==========================================================================
+//
+// Output of one BSP worker thread
+//
+// With more than one worker nothing can be put into the shared lists
+// directly. Each worker allocates from its own arena and records what
+// it wants to add, tagged with the index of the job that produced it.
+// Once all workers are done the main thread replays these in job order
+// so that the result is the same as with a single worker.
+//
+//==========================================================================
+
+enum
+{
+	MAX_BSP_WORKERS = 16
+};
+
+struct HWBspEvent
+{
+	enum
+	{
+		Wall,
+		Flat,
+		Sprite,
+		Decal,
+		Portal,
+		UpperMissing,
+		LowerMissing,
+		SubsectorPortal,
+	};
+
+	int job;
+	int type;
+	int list;		// draw list, decal list or portal type
+	int plane;
+	area_t area;
+	float height;
+	void *item;
+	void *item2;
+};
+
+struct HWBspWorkerOutput
+{
+	FMemArena Allocator{ 1024 * 1024 };
+	TArray<HWBspEvent> Events;
+	int Job;
+	area_t Area;
+
+	// Statistics, added to the global ones when the output gets merged.
+	int RenderedLines, RenderedFlats, RenderedSprites;
+	glcycle_t Total, SetupWall, SetupFlat, SetupSprite;
+
+	void ResetStats()
+	{
+		RenderedLines = RenderedFlats = RenderedSprites = 0;
+		Total.Reset();
+		SetupWall.Reset();
+		SetupFlat.Reset();
+		SetupSprite.Reset();
+	}
+
+	void AddEvent(int type, int list, int plane, float height, void *item, void *item2 = nullptr)
+	{
+		Events.Push({ Job, type, list, plane, Area, height, item, item2 });
+	}
+
+	void *NewItem(int type, int list, size_t size, int plane = -1)
+	{
+		auto item = Allocator.Alloc(size);
+		AddEvent(type, list, plane, 0, item);
+		return item;
+	}
+};
+
+extern HWBspWorkerOutput BspWorkerOutputs[MAX_BSP_WORKERS];
+extern thread_local HWBspWorkerOutput *bspWorkerOutput;	// only set on BSP worker threads
 
 //==========================================================================
 //
@@ -92,6 +171,12 @@ public:
 	HWFlat *NewFlat();
 	HWSprite *NewSprite();
 	void Reset();
+
+	// for items that were allocated by a BSP worker.
+	void PushWall(HWWall *wall) { drawitems.Push(HWDrawItem(DrawType_WALL, walls.Push(wall))); }
+	void PushFlat(HWFlat *flat) { drawitems.Push(HWDrawItem(DrawType_FLAT, flats.Push(flat))); }
+	void PushSprite(HWSprite *sprite) { drawitems.Push(HWDrawItem(DrawType_SPRITE, sprites.Push(sprite))); }
+
 	void SortWalls();
 	void SortFlats();
 	
@@ -39,15 +39,15 @@ EXTERN_CVAR(Bool, gl_seamless)
 
 void HWDrawInfo::AddWall(HWWall *wall)
 {
+	int list;
+
 	if (wall->flags & HWWall::HWF_TRANSLUCENT)
 	{
-		auto newwall = drawlists[GLDL_TRANSLUCENT].NewWall();
-		*newwall = *wall;
+		list = GLDL_TRANSLUCENT;
 	}
 	else
 	{
 		bool masked = HWWall::passflag[wall->type] == 1 ? false : (wall->texture && wall->texture->isMasked());
-		int list;
 
 		if (wall->flags & HWWall::HWF_SKYHACK && wall->type == RENDERWALL_M2S)
 		{
@@ -57,9 +57,9 @@ void HWDrawInfo::AddWall(HWWall *wall)
 		{
 			list = masked ? GLDL_MASKEDWALLS : GLDL_PLAINWALLS;
 		}
-		auto newwall = drawlists[list].NewWall();
-		*newwall = *wall;
 	}
+	auto newwall = bspWorkerOutput ? (HWWall*)bspWorkerOutput->NewItem(HWBspEvent::Wall, list, sizeof(HWWall)) : drawlists[list].NewWall();
+	*newwall = *wall;
 }
 
 //==========================================================================
@@ -130,7 +130,7 @@ void HWDrawInfo::AddFlat(HWFlat *flat, bool fog)
 		bool masked = flat->texture->isMasked() && ((flat->renderflags&SSRF_RENDER3DPLANES) || flat->stack);
 		list = masked ? GLDL_MASKEDFLATS : GLDL_PLAINFLATS;
 	}
-	auto newflat = drawlists[list].NewFlat();
+	auto newflat = bspWorkerOutput ? (HWFlat*)bspWorkerOutput->NewItem(HWBspEvent::Flat, list, sizeof(HWFlat)) : drawlists[list].NewFlat();
 	*newflat = *flat;
 }
 
@@ -153,7 +153,7 @@ void HWDrawInfo::AddSprite(HWSprite *sprite, bool translucent)
 		list = GLDL_MODELS;
 	}
 
-	auto newsprt = drawlists[list].NewSprite();
+	auto newsprt = bspWorkerOutput ? (HWSprite*)bspWorkerOutput->NewItem(HWBspEvent::Sprite, list, sizeof(HWSprite)) : drawlists[list].NewSprite();
 	*newsprt = *sprite;
 }
 
@@ -385,6 +385,7 @@ public:
 	float x2,y2,z2;
 	float offx, offy;
 	float trans;
+	float isotheta;	// rotation angle to compensate for Y-billboarding of isometric sprites
 	int dynlightindex;
 
 	FGameTexture *texture;
@@ -195,6 +195,11 @@ void HWDrawInfo::AddOtherCeilingPlane(int sector, gl_subsectorrendernode * node)
 //==========================================================================
 void HWDrawInfo::AddUpperMissingTexture(side_t * side, subsector_t *sub, float Backheight)
 {
+	if (bspWorkerOutput)
+	{
+		bspWorkerOutput->AddEvent(HWBspEvent::UpperMissing, 0, -1, Backheight, side, sub);
+		return;
+	}
 	if (!side->segs[0]->backsector) return;
 
 	for (int i = 0; i < side->numsegs; i++)
@@ -247,6 +252,11 @@ void HWDrawInfo::AddUpperMissingTexture(side_t * side, subsector_t *sub, float B
 //==========================================================================
 void HWDrawInfo::AddLowerMissingTexture(side_t * side, subsector_t *sub, float Backheight)
 {
+	if (bspWorkerOutput)
+	{
+		bspWorkerOutput->AddEvent(HWBspEvent::LowerMissing, 0, -1, Backheight, side, sub);
+		return;
+	}
 	sector_t *backsec = side->segs[0]->backsector;
 	if (!backsec) return;
 	if (backsec->transdoor)
@@ -531,7 +531,7 @@ bool HWSprite::CalculateVertices(HWDrawInfo* di, FVector3* v, DVector3* vp)
 				float angleRad = (FAngle::fromDeg(270.) - HWAngles.Yaw).Radians();
 				mat.Translate(center.X, center.Z, center.Y);
 				mat.Translate(0.0, z2 - center.Z, 0.0);
-				mat.Rotate(-sin(angleRad), 0, cos(angleRad), -actor->isotheta);
+				mat.Rotate(-sin(angleRad), 0, cos(angleRad), -isotheta);
 				mat.Translate(0.0, center.Z - z2, 0.0);
 				mat.Translate(-center.X, -center.Z, -center.Y);
 			}
@@ -1001,10 +1001,9 @@ void HWSprite::Process(HWDrawInfo *di, AActor* thing, sector_t * sector, area_t
 		auto r = spi.GetSpriteRect();
 
 		// [SP] SpriteFlip
-		if (thing->renderflags & RF_SPRITEFLIP)
-			thing->renderflags ^= RF_XFLIP;
+		bool xflip = !!(thing->renderflags & RF_XFLIP) ^ !!(thing->renderflags & RF_SPRITEFLIP);
 
-		if (mirror ^ !!(thing->renderflags & RF_XFLIP))
+		if (mirror ^ xflip)
 		{
 			r.left = -r.width - r.left;	// mirror the sprite's x-offset
 			ul = spi.GetSpriteUL();
@@ -1020,14 +1019,12 @@ void HWSprite::Process(HWDrawInfo *di, AActor* thing, sector_t * sector, area_t
 		if (!texture || !texture->isValid())
 			return;
 
-		if (thing->renderflags & RF_SPRITEFLIP) // [SP] Flip back
-			thing->renderflags ^= RF_XFLIP;
-
 		// If sprite is isometric, do both vertical scaling and partial rotation to face the camera to compensate for Y-billboarding.
 		// Using just rotation (about z=0) might cause tall+slender (high aspect ratio) sprites to clip out of collision box
 		// at the top and clip into whatever is behind them from the viewpoint's perspective. - [DVR]
-		thing->isoscaleY = 1.0;
-		thing->isotheta = vp.HWAngles.Pitch.Degrees();
+		// These are kept per sprite rather than in the actor because BSP worker jobs may process the same actor concurrently through portals.
+		float isoscaleY = 1.0;
+		isotheta = vp.HWAngles.Pitch.Degrees();
 		if (thing->renderflags2 & RF2_ISOMETRICSPRITES)
 		{
 			float floordist = thing->radius * vp.floordistfact;
@@ -1036,12 +1033,12 @@ void HWSprite::Process(HWDrawInfo *di, AActor* thing, sector_t * sector, area_t
 			double scl = g_sqrt( 1.0 + sineisotheta * sineisotheta - 2.0 * vp.PitchSin * sineisotheta );
 			if ((thing->radius > 0.0) && (scl > fabs(vp.PitchCos)))
 			{
-				thing->isoscaleY = scl / ( fabs(vp.PitchCos) > 0.01 ? fabs(vp.PitchCos) : 0.01 );
-				thing->isotheta = 180.0 * asin( sineisotheta / thing->isoscaleY ) / M_PI;
+				isoscaleY = scl / ( fabs(vp.PitchCos) > 0.01 ? fabs(vp.PitchCos) : 0.01 );
+				isotheta = 180.0 * asin( sineisotheta / isoscaleY ) / M_PI;
 			}
 		}
 
-		r.Scale(sprscale.X, isSpriteShadow ? sprscale.Y * 0.15 * thing->isoscaleY : sprscale.Y * thing->isoscaleY);
+		r.Scale(sprscale.X, isSpriteShadow ? sprscale.Y * 0.15 * isoscaleY : sprscale.Y * isoscaleY);
 
 		if (((thing->renderflags & RF_ROLLSPRITE) || (thing->renderflags2 & RF2_SQUAREPIXELS)) && !(thing->renderflags2 & RF2_STRETCHPIXELS))
 		{
@@ -1055,7 +1052,7 @@ void HWSprite::Process(HWDrawInfo *di, AActor* thing, sector_t * sector, area_t
 		z1 = z - r.top;
 		z2 = z1 - r.height;
 
-		float spriteheight = sprscale.Y * r.height * thing->isoscaleY;
+		float spriteheight = sprscale.Y * r.height * isoscaleY;
 
 		// Tests show that this doesn't look good for many decorations and corpses
 		if (spriteheight > 0 && gl_spriteclip > 0 && (thing->renderflags & RF_SPRITETYPEMASK) == RF_FACESPRITE)
@@ -1394,7 +1391,8 @@ void HWSprite::Process(HWDrawInfo *di, AActor* thing, sector_t * sector, area_t
 	}
 
 	PutSprite(di, hw_styleflags != STYLEHW_Solid);
-	rendered_sprites++;
+	if (bspWorkerOutput) bspWorkerOutput->RenderedSprites++;
+	else rendered_sprites++;
 }
 
 
@@ -1578,7 +1576,8 @@ void HWSprite::ProcessParticle(HWDrawInfo *di, particle_t *particle, sector_t *s
 		lightlist = nullptr;
 
 	PutSprite(di, hw_styleflags != STYLEHW_Solid);
-	rendered_sprites++;
+	if (bspWorkerOutput) bspWorkerOutput->RenderedSprites++;
+	else rendered_sprites++;
 }
 
 // [MC] VisualThinkers are to be rendered akin to actor sprites. The reason this whole system
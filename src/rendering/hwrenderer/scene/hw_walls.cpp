@@ -584,7 +584,14 @@ void HWWall::PutPortal(HWWallDispatcher *di, int ptype, int plane)
 	HWPortal * portal = nullptr;
 
 	auto ddi = di->di;
-	if (ddi)
+	if (ddi && bspWorkerOutput)
+	{
+		// The portal list is shared by all BSP workers so this must wait for the main thread.
+		auto wall = (HWWall*)bspWorkerOutput->NewItem(HWBspEvent::Portal, ptype, sizeof(HWWall), plane);
+		*wall = *this;
+		vertcount = 0;
+	}
+	else if (ddi)
 	{
 		MakeVertices(false);
 		switch (ptype)
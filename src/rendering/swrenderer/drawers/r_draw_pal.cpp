@@ -91,6 +91,15 @@ EXTERN_CVAR(Int, gl_particles_style)
 	algorithm that uses RGB tables.
 */
 
+/*
+	The drawers in this file are deliberately kept scalar. Nearly all of
+	their work is in texture, colormap and blend table lookups. SSE and NEON
+	can only do those one byte at a time. Vectorizing the rest, i.e. the
+	texel addressing and the RGB32k index math, and staging four pixels
+	through arrays made the translucent and additive drawers slower than
+	this code.
+*/
+
 namespace swrenderer
 {
 	uint8_t SWPalDrawers::AddLightsColumn(const DrawerLight *lights, int num_lights, float viewpos_z, uint8_t fg, uint8_t material)
@@ -59,6 +59,10 @@
 #include "r_draw_sprite32_sse2.h"
 #include "r_draw_span32_sse2.h"
 #include "r_draw_sky32_sse2.h"
+#include "r_draw_wall32_avx2.h"
+#include "r_draw_sprite32_avx2.h"
+#include "r_draw_span32_avx2.h"
+#include "x86.h"
 #endif
 
 #include "gi.h"
@@ -78,8 +82,41 @@ CVAR(Bool, r_mipmap, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 // Level of detail texture bias
 CVAR(Float, r_lod_bias, -1.5, 0); // To do: add CVAR_ARCHIVE | CVAR_GLOBALCONFIG when a good default has been decided
 
+// Use the AVX2 drawers when the CPU supports them
+CVAR(Bool, r_avx2drawers, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
+
 namespace swrenderer
 {
+#ifndef NO_SSE
+	// Maps a drawer to its AVX2 version. Drawers without one map to themselves.
+	template<typename DrawerT> struct AVX2Drawer { typedef DrawerT Type; };
+	template<typename BlendT> struct AVX2Drawer<DrawWall32T<BlendT>> { typedef DrawWall32AVX2T<BlendT> Type; };
+	template<typename BlendT> struct AVX2Drawer<DrawSpan32T<BlendT>> { typedef DrawSpan32AVX2T<BlendT> Type; };
+	template<typename BlendT, typename SamplerT> struct AVX2Drawer<DrawSprite32T<BlendT, SamplerT>> { typedef DrawSprite32AVX2T<BlendT, SamplerT> Type; };
+#endif
+
+	bool SWTruecolorDrawers::AVX2Supported()
+	{
+#ifndef NO_SSE
+		return CanUseAVX2(&CPU);
+#else
+		return false;
+#endif
+	}
+
+	template<typename DrawerT, typename ArgsT>
+	void SWTruecolorDrawers::DrawColumnT(const ArgsT &args)
+	{
+#ifndef NO_SSE
+		if (HasAVX2 && r_avx2drawers)
+		{
+			AVX2Drawer<DrawerT>::Type::DrawColumn(args);
+			return;
+		}
+#endif
+		DrawerT::DrawColumn(args);
+	}
+
 	void SWTruecolorDrawers::DrawWall(const WallDrawerArgs &args)
 	{
 		DrawWallColumns<DrawWall32Command>(args);
@@ -112,32 +149,32 @@ namespace swrenderer
 	
 	void SWTruecolorDrawers::DrawColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSprite32Command::DrawColumn(args);
+		DrawColumnT<DrawSprite32Command>(args);
 	}
 
 	void SWTruecolorDrawers::FillColumn(const SpriteDrawerArgs &args)
 	{
-		FillSprite32Command::DrawColumn(args);
+		DrawColumnT<FillSprite32Command>(args);
 	}
 
 	void SWTruecolorDrawers::FillAddColumn(const SpriteDrawerArgs &args)
 	{
-		FillSpriteAddClamp32Command::DrawColumn(args);
+		DrawColumnT<FillSpriteAddClamp32Command>(args);
 	}
 
 	void SWTruecolorDrawers::FillAddClampColumn(const SpriteDrawerArgs &args)
 	{
-		FillSpriteAddClamp32Command::DrawColumn(args);
+		DrawColumnT<FillSpriteAddClamp32Command>(args);
 	}
 
 	void SWTruecolorDrawers::FillSubClampColumn(const SpriteDrawerArgs &args)
 	{
-		FillSpriteSubClamp32Command::DrawColumn(args);
+		DrawColumnT<FillSpriteSubClamp32Command>(args);
 	}
 
 	void SWTruecolorDrawers::FillRevSubClampColumn(const SpriteDrawerArgs &args)
 	{
-		FillSpriteRevSubClamp32Command::DrawColumn(args);
+		DrawColumnT<FillSpriteRevSubClamp32Command>(args);
 	}
 
 	void SWTruecolorDrawers::DrawFuzzColumn(const SpriteDrawerArgs &args)
@@ -151,87 +188,87 @@ namespace swrenderer
 
 	void SWTruecolorDrawers::DrawAddColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteAddClamp32Command::DrawColumn(args);
+		DrawColumnT<DrawSpriteAddClamp32Command>(args);
 	}
 
 	void SWTruecolorDrawers::DrawTranslatedColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteTranslated32Command::DrawColumn(args);
+		DrawColumnT<DrawSpriteTranslated32Command>(args);
 	}
 
 	void SWTruecolorDrawers::DrawTranslatedAddColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteTranslatedAddClamp32Command::DrawColumn(args);
+		DrawColumnT<DrawSpriteTranslatedAddClamp32Command>(args);
 	}
 
 	void SWTruecolorDrawers::DrawShadedColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteShaded32Command::DrawColumn(args);
+		DrawColumnT<DrawSpriteShaded32Command>(args);
 	}
 
 	void SWTruecolorDrawers::DrawAddClampShadedColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteAddClampShaded32Command::DrawColumn(args);
+		DrawColumnT<DrawSpriteAddClampShaded32Command>(args);
 	}
 
 	void SWTruecolorDrawers::DrawAddClampColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteAddClamp32Command::DrawColumn(args);
+		DrawColumnT<DrawSpriteAddClamp32Command>(args);
 	}
 
 	void SWTruecolorDrawers::DrawAddClampTranslatedColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteTranslatedAddClamp32Command::DrawColumn(args);
+		DrawColumnT<DrawSpriteTranslatedAddClamp32Command>(args);
 	}
 
 	void SWTruecolorDrawers::DrawSubClampColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteSubClamp32Command::DrawColumn(args);
+		DrawColumnT<DrawSpriteSubClamp32Command>(args);
 	}
 
 	void SWTruecolorDrawers::DrawSubClampTranslatedColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteTranslatedSubClamp32Command::DrawColumn(args);
+		DrawColumnT<DrawSpriteTranslatedSubClamp32Command>(args);
 	}
 
 	void SWTruecolorDrawers::DrawRevSubClampColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteRevSubClamp32Command::DrawColumn(args);
+		DrawColumnT<DrawSpriteRevSubClamp32Command>(args);
 	}
 
 	void SWTruecolorDrawers::DrawRevSubClampTranslatedColumn(const SpriteDrawerArgs &args)
 	{
-		DrawSpriteTranslatedRevSubClamp32Command::DrawColumn(args);
+		DrawColumnT<DrawSpriteTranslatedRevSubClamp32Command>(args);
 	}
 
 	void SWTruecolorDrawers::DrawSpan(const SpanDrawerArgs &args)
 	{
-		DrawSpan32Command::DrawColumn(args);
+		DrawColumnT<DrawSpan32Command>(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanMasked(const SpanDrawerArgs &args)
 	{
-		DrawSpanMasked32Command::DrawColumn(args);
+		DrawColumnT<DrawSpanMasked32Command>(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanTranslucent(const SpanDrawerArgs &args)
 	{
-		DrawSpanTranslucent32Command::DrawColumn(args);
+		DrawColumnT<DrawSpanTranslucent32Command>(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanMaskedTranslucent(const SpanDrawerArgs &args)
 	{
-		DrawSpanAddClamp32Command::DrawColumn(args);
+		DrawColumnT<DrawSpanAddClamp32Command>(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanAddClamp(const SpanDrawerArgs &args)
 	{
-		DrawSpanTranslucent32Command::DrawColumn(args);
+		DrawColumnT<DrawSpanTranslucent32Command>(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSpanMaskedAddClamp(const SpanDrawerArgs &args)
 	{
-		DrawSpanAddClamp32Command::DrawColumn(args);
+		DrawColumnT<DrawSpanAddClamp32Command>(args);
 	}
 	
 	void SWTruecolorDrawers::DrawSingleSkyColumn(const SkyDrawerArgs &args)
@@ -1014,7 +1051,7 @@ namespace swrenderer
 
 			for (int j = 0; j < block.width; j++)
 			{
-				DrawSprite32Command::DrawColumn(drawerargs);
+				DrawColumnT<DrawSprite32Command>(drawerargs);
 				drawerargs.dc_dest += 4;
 			}
 		}
@@ -1168,6 +1205,6 @@ namespace swrenderer
 		drawerargs.SetTextureUPos(texturefracx);
 		drawerargs.SetTextureVPos(texelY);
 		drawerargs.SetTextureVStep(texelStepY);
-		DrawerT::DrawColumn(drawerargs);
+		DrawColumnT<DrawerT>(drawerargs);
 	}
 }
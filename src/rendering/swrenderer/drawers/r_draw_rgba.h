@@ -71,6 +71,13 @@ namespace swrenderer
 	#define VECTORCALL
 	#endif
 
+	// Lets the AVX2 drawers use AVX2 instructions without compiling the whole file for it
+	#if defined(__GNUC__)
+	#define AVX2_TARGET __attribute__((target("avx2")))
+	#else
+	#define AVX2_TARGET
+	#endif
+
 	template<typename CommandType, typename BlendMode>
 	class DrawerBlendCommand : public CommandType
 	{
@@ -136,10 +143,14 @@ namespace swrenderer
 		void DrawScaledFuzzColumn(const SpriteDrawerArgs& args);
 		void DrawUnscaledFuzzColumn(const SpriteDrawerArgs& args);
 
+		template<typename DrawerT, typename ArgsT> void DrawColumnT(const ArgsT& args);
 		template<typename DrawerT> void DrawWallColumns(const WallDrawerArgs& args);
 		template<typename DrawerT> void DrawWallColumn32(WallColumnDrawerArgs& drawerargs, int x, int y1, int y2, uint32_t texelX, uint32_t texelY, uint32_t texelStepX, uint32_t texelStepY);
 
+		static bool AVX2Supported();
+
 		WallColumnDrawerArgs wallcolargs;
+		bool HasAVX2 = AVX2Supported();
 	};
 
 	/////////////////////////////////////////////////////////////////////////////
@@ -0,0 +1,162 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright 2024 GZDoom Maintainers and Contributors
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//		Helpers shared by the AVX2 versions of the truecolor drawers.
+//
+//		The AVX2 drawers process four pixels per iteration. Pixel 0 and 1
+//		are kept in the low 128 bits and pixel 2 and 3 in the high 128
+//		bits, each half in exactly the layout the SSE2 drawers use. As
+//		all AVX2 integer operations used here work on the two halves
+//		independently, the output is identical to the SSE2 drawers.
+//
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "swrenderer/drawers/r_draw_rgba.h"
+
+namespace swrenderer
+{
+	namespace DrawAVX2
+	{
+		enum class ClampOp { Add, Sub, RevSub };
+
+		// Same value in both 128 bit halves
+		AVX2_TARGET FORCEINLINE __m256i VECTORCALL Broadcast(__m128i value)
+		{
+			return _mm256_inserti128_si256(_mm256_castsi128_si256(value), value, 1);
+		}
+
+		AVX2_TARGET FORCEINLINE __m256i VECTORCALL Combine(__m128i lo, __m128i hi)
+		{
+			return _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+		}
+
+		// Four BGRA8 pixels expanded to 16 bit channels
+		AVX2_TARGET FORCEINLINE __m256i VECTORCALL UnpackPixels(const uint32_t *pixels)
+		{
+			return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)pixels));
+		}
+
+		// 16 bit channels back to four pixels with full alpha
+		AVX2_TARGET FORCEINLINE __m128i VECTORCALL PackPixels(__m256i color)
+		{
+			color = _mm256_packus_epi16(color, _mm256_setzero_si256());
+			color = _mm256_or_si256(color, _mm256_set1_epi32(0xff000000));
+			return _mm256_castsi256_si128(_mm256_permute4x64_epi64(color, _MM_SHUFFLE(3, 1, 2, 0)));
+		}
+
+		// One value per pixel, repeated for all four channels
+		AVX2_TARGET FORCEINLINE __m256i VECTORCALL PixelWords(uint32_t v0, uint32_t v1, uint32_t v2, uint32_t v3)
+		{
+			return _mm256_set_epi16(v3, v3, v3, v3, v2, v2, v2, v2, v1, v1, v1, v1, v0, v0, v0, v0);
+		}
+
+		FORCEINLINE int Intensity(unsigned int color, int desaturate)
+		{
+			return ((RPART(color) * 77 + GPART(color) * 143 + BPART(color) * 37) >> 8) * desaturate;
+		}
+
+		// The desaturate, fade and light part of the advanced shade mode
+		AVX2_TARGET FORCEINLINE __m256i VECTORCALL ShadeAdvanced(__m256i fgcolor, const unsigned int *ifgcolor, __m256i mlight, int desaturate, __m256i inv_desaturate, __m256i shade_fade, __m256i shade_light)
+		{
+			int intensity0 = Intensity(ifgcolor[0], desaturate);
+			int intensity1 = Intensity(ifgcolor[1], desaturate);
+			int intensity2 = Intensity(ifgcolor[2], desaturate);
+			int intensity3 = Intensity(ifgcolor[3], desaturate);
+			__m256i intensity = _mm256_set_epi16(0, intensity3, intensity3, intensity3, 0, intensity2, intensity2, intensity2, 0, intensity1, intensity1, intensity1, 0, intensity0, intensity0, intensity0);
+
+			fgcolor = _mm256_srli_epi16(_mm256_add_epi16(_mm256_mullo_epi16(fgcolor, inv_desaturate), intensity), 8);
+			fgcolor = _mm256_mullo_epi16(fgcolor, mlight);
+			fgcolor = _mm256_srli_epi16(_mm256_add_epi16(shade_fade, fgcolor), 8);
+			fgcolor = _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, shade_light), 8);
+			return fgcolor;
+		}
+
+		// Dynamic lights are rare and float based, so they run through the SSE2 code one half at a time
+		template<typename SSE2T>
+		AVX2_TARGET FORCEINLINE __m256i VECTORCALL AddLights(__m256i material, __m256i fgcolor, const DrawerLight *lights, int num_lights, __m128 viewpos_lo, __m128 viewpos_hi)
+		{
+			if (num_lights == 0)
+				return _mm256_min_epi16(fgcolor, _mm256_set1_epi16(255));
+
+			__m128i lo = SSE2T::AddLights(_mm256_castsi256_si128(material), _mm256_castsi256_si128(fgcolor), lights, num_lights, viewpos_lo);
+			__m128i hi = SSE2T::AddLights(_mm256_extracti128_si256(material, 1), _mm256_extracti128_si256(fgcolor, 1), lights, num_lights, viewpos_hi);
+			return Combine(lo, hi);
+		}
+
+		AVX2_TARGET FORCEINLINE __m256i VECTORCALL BlendMasked(__m256i fgcolor, __m256i bgcolor)
+		{
+			__m256i mask = _mm256_cmpeq_epi32(_mm256_packus_epi16(fgcolor, _mm256_setzero_si256()), _mm256_setzero_si256());
+			mask = _mm256_unpacklo_epi8(mask, _mm256_setzero_si256());
+			return _mm256_or_si256(_mm256_and_si256(mask, bgcolor), _mm256_andnot_si256(mask, fgcolor));
+		}
+
+		template<ClampOp Op>
+		AVX2_TARGET FORCEINLINE __m256i VECTORCALL BlendClamp(__m256i fgcolor, __m256i bgcolor, __m256i fgalpha, __m256i bgalpha)
+		{
+			fgcolor = _mm256_mullo_epi16(fgcolor, fgalpha);
+			bgcolor = _mm256_mullo_epi16(bgcolor, bgalpha);
+
+			__m256i fg_lo = _mm256_unpacklo_epi16(fgcolor, _mm256_setzero_si256());
+			__m256i bg_lo = _mm256_unpacklo_epi16(bgcolor, _mm256_setzero_si256());
+			__m256i fg_hi = _mm256_unpackhi_epi16(fgcolor, _mm256_setzero_si256());
+			__m256i bg_hi = _mm256_unpackhi_epi16(bgcolor, _mm256_setzero_si256());
+
+			__m256i out_lo, out_hi;
+			if (Op == ClampOp::Add)
+			{
+				out_lo = _mm256_add_epi32(fg_lo, bg_lo);
+				out_hi = _mm256_add_epi32(fg_hi, bg_hi);
+			}
+			else if (Op == ClampOp::Sub)
+			{
+				out_lo = _mm256_sub_epi32(fg_lo, bg_lo);
+				out_hi = _mm256_sub_epi32(fg_hi, bg_hi);
+			}
+			else
+			{
+				out_lo = _mm256_sub_epi32(bg_lo, fg_lo);
+				out_hi = _mm256_sub_epi32(bg_hi, fg_hi);
+			}
+
+			out_lo = _mm256_srai_epi32(out_lo, 8);
+			out_hi = _mm256_srai_epi32(out_hi, 8);
+			return _mm256_packs_epi32(out_lo, out_hi);
+		}
+
+		// Blends using the alpha channel of the source pixels
+		template<ClampOp Op>
+		AVX2_TARGET FORCEINLINE __m256i VECTORCALL BlendClampAlpha(__m256i fgcolor, __m256i bgcolor, const unsigned int *ifgcolor, uint32_t srcalpha, uint32_t destalpha)
+		{
+			uint32_t fgalpha[4], bgalpha[4];
+			for (int i = 0; i < 4; i++)
+			{
+				uint32_t alpha = APART(ifgcolor[i]);
+				alpha += alpha >> 7; // 255->256
+				uint32_t inv_alpha = 256 - alpha;
+				bgalpha[i] = (destalpha * alpha + (inv_alpha << 8) + 128) >> 8;
+				fgalpha[i] = (srcalpha * alpha + 128) >> 8;
+			}
+
+			return BlendClamp<Op>(fgcolor, bgcolor, PixelWords(fgalpha[0], fgalpha[1], fgalpha[2], fgalpha[3]), PixelWords(bgalpha[0], bgalpha[1], bgalpha[2], bgalpha[3]));
+		}
+	}
+}
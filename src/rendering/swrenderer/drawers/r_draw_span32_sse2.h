@@ -67,11 +67,9 @@ namespace swrenderer
 			const uint32_t *source;
 		};
 
-		static void DrawColumn(const SpanDrawerArgs& args)
+		// Picks the mipmap level. Returns true if nearest filtering should be used.
+		static bool SetupTextureData(const SpanDrawerArgs& args, TextureData &texdata)
 		{
-			using namespace DrawSpan32TModes;
-
-			TextureData texdata;
 			texdata.width = args.TextureWidth();
 			texdata.height = args.TextureHeight();
 			texdata.xstep = args.TextureUStep();
@@ -103,7 +101,15 @@ namespace swrenderer
 			texdata.xone = (0x80000000u / texdata.width) << 1;
 			texdata.yone = (0x80000000u / texdata.height) << 1;
 
-			bool is_nearest_filter = (magnifying && !r_magfilter) || (!magnifying && !r_minfilter);
+			return (magnifying && !r_magfilter) || (!magnifying && !r_minfilter);
+		}
+
+		static void DrawColumn(const SpanDrawerArgs& args)
+		{
+			using namespace DrawSpan32TModes;
+
+			TextureData texdata;
+			bool is_nearest_filter = SetupTextureData(args, texdata);
 			bool is_64x64 = texdata.width == 64 && texdata.height == 64;
 			
 			auto shade_constants = args.ColormapConstants();
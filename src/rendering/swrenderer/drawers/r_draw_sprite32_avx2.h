@@ -0,0 +1,250 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright 2024 GZDoom Maintainers and Contributors
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//		AVX2 version of the truecolor sprite drawers. Four pixels per
+//		iteration, producing the same output as DrawSprite32T.
+//
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "swrenderer/drawers/r_draw_sprite32_sse2.h"
+#include "swrenderer/drawers/r_draw_rgba_avx2.h"
+
+namespace swrenderer
+{
+	template<typename BlendT, typename SamplerT>
+	class DrawSprite32AVX2T
+	{
+	public:
+		typedef DrawSprite32T<BlendT, SamplerT> SSE2;
+
+		AVX2_TARGET static void DrawColumn(const SpriteDrawerArgs& args)
+		{
+			using namespace DrawSprite32TModes;
+
+			auto shade_constants = args.ColormapConstants();
+			if (SamplerT::Mode == (int)SpriteSamplers::Texture)
+			{
+				const uint32_t *source2 = (const uint32_t*)args.TexturePixels2();
+				bool is_nearest_filter = (source2 == nullptr);
+
+				if (shade_constants.simple_shade)
+				{
+					if (is_nearest_filter)
+						Loop<SimpleShade, NearestFilter>(args, shade_constants);
+					else
+						Loop<SimpleShade, LinearFilter>(args, shade_constants);
+				}
+				else
+				{
+					if (is_nearest_filter)
+						Loop<AdvancedShade, NearestFilter>(args, shade_constants);
+					else
+						Loop<AdvancedShade, LinearFilter>(args, shade_constants);
+				}
+			}
+			else // no linear filtering for translated, shaded or fill
+			{
+				if (shade_constants.simple_shade)
+				{
+					Loop<SimpleShade, NearestFilter>(args, shade_constants);
+				}
+				else
+				{
+					Loop<AdvancedShade, NearestFilter>(args, shade_constants);
+				}
+			}
+		}
+
+		template<typename ShadeModeT, typename FilterModeT>
+		AVX2_TARGET FORCEINLINE static void VECTORCALL Loop(const SpriteDrawerArgs& args, ShadeConstants shade_constants)
+		{
+			using namespace DrawSprite32TModes;
+
+			const uint32_t *source;
+			const uint32_t *source2;
+			const uint8_t *colormap;
+			const uint32_t *translation;
+
+			if (SamplerT::Mode == (int)SpriteSamplers::Shaded || SamplerT::Mode == (int)SpriteSamplers::Translated)
+			{
+				source = (const uint32_t*)args.TexturePixels();
+				source2 = nullptr;
+				colormap = args.Colormap(args.Viewport());
+				translation = (const uint32_t*)args.TranslationMap();
+			}
+			else
+			{
+				source = (const uint32_t*)args.TexturePixels();
+				source2 = (const uint32_t*)args.TexturePixels2();
+				colormap = nullptr;
+				translation = nullptr;
+			}
+
+			int textureheight = args.TextureHeight();
+			uint32_t one = ((0x20000000 + textureheight - 1) / textureheight) * 2 + 1;
+
+			// Shade constants
+			__m128i dynlight = _mm_cvtsi32_si128(args.DynamicLight());
+			dynlight = _mm_unpacklo_epi8(dynlight, _mm_setzero_si128());
+			dynlight = _mm_shuffle_epi32(dynlight, _MM_SHUFFLE(1, 0, 1, 0));
+			int light = 256 - (args.Light() >> (FRACBITS - 8));
+			__m128i mlight = _mm_set_epi16(256, light, light, light, 256, light, light, light);
+
+			__m256i inv_desaturate, shade_fade, shade_light, lightcontrib;
+			int desaturate;
+			if (ShadeModeT::Mode == (int)ShadeMode::Advanced)
+			{
+				__m128i inv_light = _mm_set_epi16(0, 256 - light, 256 - light, 256 - light, 0, 256 - light, 256 - light, 256 - light);
+				inv_desaturate = DrawAVX2::Broadcast(_mm_setr_epi16(256, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate));
+				__m128i fade = _mm_set_epi16(shade_constants.fade_alpha, shade_constants.fade_red, shade_constants.fade_green, shade_constants.fade_blue, shade_constants.fade_alpha, shade_constants.fade_red, shade_constants.fade_green, shade_constants.fade_blue);
+				shade_fade = DrawAVX2::Broadcast(_mm_mullo_epi16(fade, inv_light));
+				shade_light = DrawAVX2::Broadcast(_mm_set_epi16(shade_constants.light_alpha, shade_constants.light_red, shade_constants.light_green, shade_constants.light_blue, shade_constants.light_alpha, shade_constants.light_red, shade_constants.light_green, shade_constants.light_blue));
+				desaturate = shade_constants.desaturate;
+
+				__m128i contrib = _mm_min_epi16(_mm_add_epi16(mlight, dynlight), _mm_set1_epi16(256));
+				lightcontrib = DrawAVX2::Broadcast(_mm_sub_epi16(contrib, mlight));
+			}
+			else
+			{
+				inv_desaturate = _mm256_setzero_si256();
+				shade_fade = _mm256_setzero_si256();
+				shade_light = _mm256_setzero_si256();
+				desaturate = 0;
+				lightcontrib = _mm256_setzero_si256();
+
+				mlight = _mm_min_epi16(_mm_add_epi16(mlight, dynlight), _mm_set1_epi16(256));
+			}
+			__m256i mlight256 = DrawAVX2::Broadcast(mlight);
+
+			int count = args.Count();
+			if (count <= 0) return;
+			int pitch = args.Viewport()->RenderTarget->GetPitch();
+			uint32_t fracstep = args.TextureVStep();
+			uint32_t frac = args.TextureVPos();
+			uint32_t texturefracx = args.TextureUPos();
+			uint32_t *dest = (uint32_t*)args.Dest();
+
+			if (FilterModeT::Mode == (int)FilterModes::Linear)
+			{
+				frac -= one / 2;
+			}
+
+			uint32_t srcalpha = args.SrcAlpha() >> (FRACBITS - 8);
+			uint32_t destalpha = args.DestAlpha() >> (FRACBITS - 8);
+			uint32_t srccolor = args.SrcColorBgra();
+			uint32_t color = LightBgra::shade_bgra_simple(args.SolidColorBgra(),
+				LightBgra::calc_light_multiplier(light));
+
+			const bool readdest = BlendT::Mode != (int)SpriteBlendModes::Opaque && BlendT::Mode != (int)SpriteBlendModes::Copy;
+
+			int index = 0;
+			while (index < count)
+			{
+				// The last block may be partial. Unused pixels are zero just like the odd pixel in the SSE2 drawer.
+				int offset = index * pitch;
+				int pixels = min(count - index, 4);
+
+				uint32_t desttmp[4] = { 0, 0, 0, 0 };
+				unsigned int ifgcolor[4] = { 0, 0, 0, 0 };
+				unsigned int ifgshade[4] = { 0, 0, 0, 0 };
+				for (int i = 0; i < pixels; i++)
+				{
+					if (readdest)
+						desttmp[i] = dest[offset + i * pitch];
+					ifgcolor[i] = SSE2::template Sample<FilterModeT>(frac, source, source2, translation, textureheight, one, texturefracx, color, srccolor);
+					ifgshade[i] = SSE2::SampleShade(frac, source, colormap);
+					frac += fracstep;
+				}
+
+				__m256i bgcolor = readdest ? DrawAVX2::UnpackPixels(desttmp) : _mm256_setzero_si256();
+				__m256i fgcolor = DrawAVX2::UnpackPixels(ifgcolor);
+
+				fgcolor = Shade<ShadeModeT>(fgcolor, mlight256, ifgcolor, desaturate, inv_desaturate, shade_fade, shade_light, lightcontrib);
+				_mm_storeu_si128((__m128i*)desttmp, DrawAVX2::PackPixels(Blend(fgcolor, bgcolor, ifgcolor, ifgshade, srcalpha, destalpha)));
+
+				for (int i = 0; i < pixels; i++)
+					dest[offset + i * pitch] = desttmp[i];
+
+				index += 4;
+			}
+		}
+
+		template<typename ShadeModeT>
+		AVX2_TARGET FORCEINLINE static __m256i VECTORCALL Shade(__m256i fgcolor, __m256i mlight, const unsigned int *ifgcolor, int desaturate, __m256i inv_desaturate, __m256i shade_fade, __m256i shade_light, __m256i lightcontrib)
+		{
+			using namespace DrawSprite32TModes;
+
+			if (BlendT::Mode == (int)SpriteBlendModes::Copy)
+				return fgcolor;
+
+			if (ShadeModeT::Mode == (int)ShadeMode::Simple)
+			{
+				return _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, mlight), 8);
+			}
+			else
+			{
+				__m256i lit_dynlight = _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, lightcontrib), 8);
+				fgcolor = DrawAVX2::ShadeAdvanced(fgcolor, ifgcolor, mlight, desaturate, inv_desaturate, shade_fade, shade_light);
+				fgcolor = _mm256_add_epi16(fgcolor, lit_dynlight);
+				return _mm256_min_epi16(fgcolor, _mm256_set1_epi16(255));
+			}
+		}
+
+		AVX2_TARGET FORCEINLINE static __m256i VECTORCALL Blend(__m256i fgcolor, __m256i bgcolor, const unsigned int *ifgcolor, const unsigned int *ifgshade, uint32_t srcalpha, uint32_t destalpha)
+		{
+			using namespace DrawSprite32TModes;
+
+			if (BlendT::Mode == (int)SpriteBlendModes::Opaque || BlendT::Mode == (int)SpriteBlendModes::Copy)
+			{
+				return fgcolor;
+			}
+			else if (BlendT::Mode == (int)SpriteBlendModes::Shaded)
+			{
+				__m256i alpha = DrawAVX2::PixelWords(ifgshade[0], ifgshade[1], ifgshade[2], ifgshade[3]);
+				__m256i inv_alpha = _mm256_sub_epi16(_mm256_set1_epi16(256), alpha);
+
+				fgcolor = _mm256_mullo_epi16(fgcolor, alpha);
+				bgcolor = _mm256_mullo_epi16(bgcolor, inv_alpha);
+				return _mm256_srli_epi16(_mm256_add_epi16(fgcolor, bgcolor), 8);
+			}
+			else if (BlendT::Mode == (int)SpriteBlendModes::AddClampShaded)
+			{
+				__m256i alpha = DrawAVX2::PixelWords(ifgshade[0], ifgshade[1], ifgshade[2], ifgshade[3]);
+
+				fgcolor = _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, alpha), 8);
+				return _mm256_add_epi16(fgcolor, bgcolor);
+			}
+			else if (BlendT::Mode == (int)SpriteBlendModes::AddClamp)
+			{
+				return DrawAVX2::BlendClampAlpha<DrawAVX2::ClampOp::Add>(fgcolor, bgcolor, ifgcolor, srcalpha, destalpha);
+			}
+			else if (BlendT::Mode == (int)SpriteBlendModes::SubClamp)
+			{
+				return DrawAVX2::BlendClampAlpha<DrawAVX2::ClampOp::Sub>(fgcolor, bgcolor, ifgcolor, srcalpha, destalpha);
+			}
+			else
+			{
+				return DrawAVX2::BlendClampAlpha<DrawAVX2::ClampOp::RevSub>(fgcolor, bgcolor, ifgcolor, srcalpha, destalpha);
+			}
+		}
+	};
+}
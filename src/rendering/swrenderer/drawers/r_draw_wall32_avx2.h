@@ -0,0 +1,185 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright 2024 GZDoom Maintainers and Contributors
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//		AVX2 version of the truecolor wall drawers. Four pixels per
+//		iteration, producing the same output as DrawWall32T.
+//
+//-----------------------------------------------------------------------------
+
+#pragma once
+
+#include "swrenderer/drawers/r_draw_wall32_sse2.h"
+#include "swrenderer/drawers/r_draw_rgba_avx2.h"
+
+namespace swrenderer
+{
+	template<typename BlendT>
+	class DrawWall32AVX2T
+	{
+	public:
+		typedef DrawWall32T<BlendT> SSE2;
+
+		AVX2_TARGET static void DrawColumn(const WallColumnDrawerArgs& args)
+		{
+			using namespace DrawWall32TModes;
+
+			const uint32_t *source2 = (const uint32_t*)args.TexturePixels2();
+			bool is_nearest_filter = (source2 == nullptr);
+			auto shade_constants = args.ColormapConstants();
+			if (shade_constants.simple_shade)
+			{
+				if (is_nearest_filter)
+					Loop<SimpleShade, NearestFilter>(args, shade_constants);
+				else
+					Loop<SimpleShade, LinearFilter>(args, shade_constants);
+			}
+			else
+			{
+				if (is_nearest_filter)
+					Loop<AdvancedShade, NearestFilter>(args, shade_constants);
+				else
+					Loop<AdvancedShade, LinearFilter>(args, shade_constants);
+			}
+		}
+
+		template<typename ShadeModeT, typename FilterModeT>
+		AVX2_TARGET FORCEINLINE static void VECTORCALL Loop(const WallColumnDrawerArgs& args, ShadeConstants shade_constants)
+		{
+			using namespace DrawWall32TModes;
+
+			const uint32_t *source = (const uint32_t*)args.TexturePixels();
+			const uint32_t *source2 = (const uint32_t*)args.TexturePixels2();
+			int textureheight = args.TextureHeight();
+			uint32_t one = ((0x80000000 + textureheight - 1) / textureheight) * 2 + 1;
+
+			// Shade constants
+			int light = 256 - (args.Light() >> (FRACBITS - 8));
+			__m256i mlight = DrawAVX2::Broadcast(_mm_set_epi16(256, light, light, light, 256, light, light, light));
+			__m128i inv_light = _mm_set_epi16(0, 256 - light, 256 - light, 256 - light, 0, 256 - light, 256 - light, 256 - light);
+
+			__m256i inv_desaturate, shade_fade, shade_light;
+			int desaturate;
+			if (ShadeModeT::Mode == (int)ShadeMode::Advanced)
+			{
+				inv_desaturate = DrawAVX2::Broadcast(_mm_setr_epi16(256, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate, 256 - shade_constants.desaturate));
+				__m128i fade = _mm_set_epi16(shade_constants.fade_alpha, shade_constants.fade_red, shade_constants.fade_green, shade_constants.fade_blue, shade_constants.fade_alpha, shade_constants.fade_red, shade_constants.fade_green, shade_constants.fade_blue);
+				shade_fade = DrawAVX2::Broadcast(_mm_mullo_epi16(fade, inv_light));
+				shade_light = DrawAVX2::Broadcast(_mm_set_epi16(shade_constants.light_alpha, shade_constants.light_red, shade_constants.light_green, shade_constants.light_blue, shade_constants.light_alpha, shade_constants.light_red, shade_constants.light_green, shade_constants.light_blue));
+				desaturate = shade_constants.desaturate;
+			}
+			else
+			{
+				inv_desaturate = _mm256_setzero_si256();
+				shade_fade = _mm256_setzero_si256();
+				shade_light = _mm256_setzero_si256();
+				desaturate = 0;
+			}
+
+			int count = args.Count();
+			if (count <= 0) return;
+
+			int pitch = args.Viewport()->RenderTarget->GetPitch();
+			uint32_t fracstep = args.TextureVStep();
+			uint32_t frac = args.TextureVPos();
+			uint32_t texturefracx = args.TextureUPos();
+			uint32_t *dest = (uint32_t*)args.Dest();
+
+			auto lights = args.dc_lights;
+			auto num_lights = args.dc_num_lights;
+			float vpz = args.dc_viewpos.Z;
+			float stepvpz = args.dc_viewpos_step.Z;
+			__m128 viewpos_z = _mm_setr_ps(vpz, vpz + stepvpz, 0.0f, 0.0f);
+			__m128 step_viewpos_z = _mm_set1_ps(stepvpz * 2.0f);
+
+			if (FilterModeT::Mode == (int)FilterModes::Linear)
+			{
+				frac -= one / 2;
+			}
+
+			uint32_t srcalpha = args.SrcAlpha() >> (FRACBITS - 8);
+			uint32_t destalpha = args.DestAlpha() >> (FRACBITS - 8);
+
+			int index = 0;
+			while (index < count)
+			{
+				// The last block may be partial. Unused pixels are zero just like the odd pixel in the SSE2 drawer.
+				int offset = index * pitch;
+				int pixels = min(count - index, 4);
+
+				uint32_t desttmp[4] = { 0, 0, 0, 0 };
+				unsigned int ifgcolor[4] = { 0, 0, 0, 0 };
+				for (int i = 0; i < pixels; i++)
+				{
+					if (BlendT::Mode != (int)WallBlendModes::Opaque)
+						desttmp[i] = dest[offset + i * pitch];
+					ifgcolor[i] = SSE2::template Sample<FilterModeT>(frac, source, source2, textureheight, one, texturefracx);
+					frac += fracstep;
+				}
+
+				__m256i bgcolor = (BlendT::Mode != (int)WallBlendModes::Opaque) ? DrawAVX2::UnpackPixels(desttmp) : _mm256_setzero_si256();
+				__m256i fgcolor = DrawAVX2::UnpackPixels(ifgcolor);
+
+				__m128 viewpos_z_hi = _mm_add_ps(viewpos_z, step_viewpos_z);
+				fgcolor = Shade<ShadeModeT>(fgcolor, mlight, ifgcolor, desaturate, inv_desaturate, shade_fade, shade_light, lights, num_lights, viewpos_z, viewpos_z_hi);
+				_mm_storeu_si128((__m128i*)desttmp, DrawAVX2::PackPixels(Blend(fgcolor, bgcolor, ifgcolor, srcalpha, destalpha)));
+
+				for (int i = 0; i < pixels; i++)
+					dest[offset + i * pitch] = desttmp[i];
+
+				viewpos_z = _mm_add_ps(viewpos_z_hi, step_viewpos_z);
+				index += 4;
+			}
+		}
+
+		template<typename ShadeModeT>
+		AVX2_TARGET FORCEINLINE static __m256i VECTORCALL Shade(__m256i fgcolor, __m256i mlight, const unsigned int *ifgcolor, int desaturate, __m256i inv_desaturate, __m256i shade_fade, __m256i shade_light, const DrawerLight *lights, int num_lights, __m128 viewpos_z_lo, __m128 viewpos_z_hi)
+		{
+			using namespace DrawWall32TModes;
+
+			__m256i material = fgcolor;
+			if (ShadeModeT::Mode == (int)ShadeMode::Simple)
+			{
+				fgcolor = _mm256_srli_epi16(_mm256_mullo_epi16(fgcolor, mlight), 8);
+			}
+			else
+			{
+				fgcolor = DrawAVX2::ShadeAdvanced(fgcolor, ifgcolor, mlight, desaturate, inv_desaturate, shade_fade, shade_light);
+			}
+
+			return DrawAVX2::AddLights<SSE2>(material, fgcolor, lights, num_lights, viewpos_z_lo, viewpos_z_hi);
+		}
+
+		AVX2_TARGET FORCEINLINE static __m256i VECTORCALL Blend(__m256i fgcolor, __m256i bgcolor, const unsigned int *ifgcolor, uint32_t srcalpha, uint32_t destalpha)
+		{
+			using namespace DrawWall32TModes;
+
+			if (BlendT::Mode == (int)WallBlendModes::Opaque)
+				return fgcolor;
+			else if (BlendT::Mode == (int)WallBlendModes::Masked)
+				return DrawAVX2::BlendMasked(fgcolor, bgcolor);
+			else if (BlendT::Mode == (int)WallBlendModes::AddClamp)
+				return DrawAVX2::BlendClampAlpha<DrawAVX2::ClampOp::Add>(fgcolor, bgcolor, ifgcolor, srcalpha, destalpha);
+			else if (BlendT::Mode == (int)WallBlendModes::SubClamp)
+				return DrawAVX2::BlendClampAlpha<DrawAVX2::ClampOp::Sub>(fgcolor, bgcolor, ifgcolor, srcalpha, destalpha);
+			else
+				return DrawAVX2::BlendClampAlpha<DrawAVX2::ClampOp::RevSub>(fgcolor, bgcolor, ifgcolor, srcalpha, destalpha);
+		}
+	};
+}
@@ -54,36 +54,100 @@
 
 namespace swrenderer
 {
-	VisiblePlaneList::VisiblePlaneList(RenderThread *thread)
+	// Table state of the main thread's list, for stat visplanes
+	static struct
+	{
+		int planes, keys, slots, maxprobe;
+	} visplanestats;
+
+	VisiblePlaneList::VisiblePlaneList(RenderThread *thread) : VisiblePlaneList()
 	{
 		Thread = thread;
 	}
 
 	VisiblePlaneList::VisiblePlaneList()
 	{
-		for (auto &plane : visplanes)
-			plane = nullptr;
+		slots.Resize(MINSLOTS);
+		for (auto &slot : slots)
+			slot = {};
+	}
+
+	VisiblePlaneList::Slot &VisiblePlaneList::FindSlot(unsigned hash)
+	{
+		unsigned mask = slots.Size() - 1;
+		unsigned index = hash & mask;
+		int probes = 0;
+		while (slots[index].used && slots[index].hash != hash)
+		{
+			index = (index + 1) & mask;
+			probes++;
+		}
+
+		if (Thread && Thread->MainThread && probes > visplanestats.maxprobe)
+			visplanestats.maxprobe = probes;
+
+		Slot &slot = slots[index];
+		if (!slot.used)
+		{
+			slot.used = true;
+			slot.hash = hash;
+			usedslots.Push(index);
+		}
+		return slot;
+	}
+
+	void VisiblePlaneList::Grow()
+	{
+		TArray<Slot> oldslots = std::move(slots);
+		TArray<unsigned> oldused = std::move(usedslots);
+
+		slots.Resize(oldslots.Size() * 2);
+		for (auto &slot : slots)
+			slot = {};
+		usedslots.Clear();
+
+		for (unsigned index : oldused)
+		{
+			FindSlot(oldslots[index].hash).planes = oldslots[index].planes;
+		}
 	}
 
 	VisiblePlane *VisiblePlaneList::Add(unsigned hash)
+	{
+		// Keep the load factor at or below one half so the probe sequences stay short
+		if ((usedslots.Size() + 1) * 2 > slots.Size())
+			Grow();
+
+		Slot &slot = FindSlot(hash);
+		VisiblePlane *newplane = Thread->FrameMemory->NewObject<VisiblePlane>(Thread);
+		newplane->next = slot.planes;
+		slot.planes = newplane;
+		numplanes++;
+		return newplane;
+	}
+
+	VisiblePlane *VisiblePlaneList::AddPortalPlane()
 	{
 		VisiblePlane *newplane = Thread->FrameMemory->NewObject<VisiblePlane>(Thread);
-		newplane->next = visplanes[hash];
-		visplanes[hash] = newplane;
+		newplane->next = portalplanes;
+		portalplanes = newplane;
 		return newplane;
 	}
 
 	void VisiblePlaneList::Clear()
 	{
-		for (int i = 0; i <= MAXVISPLANES; i++)
-			visplanes[i] = nullptr;
+		for (unsigned index : usedslots)
+			slots[index] = {};
+		usedslots.Clear();
+		portalplanes = nullptr;
+		numplanes = 0;
 	}
 
 	void VisiblePlaneList::ClearKeepFakePlanes()
 	{
-		for (int i = 0; i <= MAXVISPLANES - 1; i++)
+		for (unsigned index : usedslots)
 		{
-			for (VisiblePlane **probe = &visplanes[i]; *probe != nullptr; )
+			for (VisiblePlane **probe = &slots[index].planes; *probe != nullptr; )
 			{
 				if ((*probe)->sky < 0)
 				{ // fake: move past it
@@ -94,6 +158,7 @@ namespace swrenderer
 					VisiblePlane *vis = *probe;
 					*probe = vis->next;
 					vis->next = nullptr;
+					numplanes--;
 				}
 			}
 		}
@@ -149,9 +214,18 @@ namespace swrenderer
 		}
 
 		// New visplane algorithm uses hash table -- killough
-		hash = isskybox ? ((unsigned)MAXVISPLANES) : CalcHash(picnum.GetIndex(), lightlevel, height);
-		
-		for (check = visplanes[hash]; check; check = check->next)	// killough
+		if (isskybox)
+		{
+			hash = 0;
+			check = portalplanes;
+		}
+		else
+		{
+			hash = CalcHash(picnum.GetIndex(), lightlevel, height);
+			check = FindSlot(hash).planes;
+		}
+
+		for (; check; check = check->next)	// killough
 		{
 			if (isskybox)
 			{
@@ -208,7 +282,7 @@ namespace swrenderer
 				}
 		}
 
-		check = Add(hash);		// killough
+		check = isskybox ? AddPortalPlane() : Add(hash);		// killough
 
 		check->height = plane;
 		check->picnum = picnum;
@@ -273,17 +347,16 @@ namespace swrenderer
 		else
 		{
 			// make a new visplane
-			unsigned hash;
+			VisiblePlane *new_pl;
 
 			if (pl->portal != nullptr && !Thread->Portal->InSkyBox(pl->portal) && viewactive)
 			{
-				hash = MAXVISPLANES;
+				new_pl = AddPortalPlane();
 			}
 			else
 			{
-				hash = CalcHash(pl->picnum.GetIndex(), pl->lightlevel, pl->height);
+				new_pl = Add(CalcHash(pl->picnum.GetIndex(), pl->lightlevel, pl->height));
 			}
-			VisiblePlane *new_pl = Add(hash);
 
 			new_pl->height = pl->height;
 			new_pl->picnum = pl->picnum;
@@ -311,15 +384,15 @@ namespace swrenderer
 
 	bool VisiblePlaneList::HasPortalPlanes() const
 	{
-		return visplanes[MAXVISPLANES] != nullptr;
+		return portalplanes != nullptr;
 	}
 
 	VisiblePlane *VisiblePlaneList::PopFirstPortalPlane()
 	{
-		VisiblePlane *pl = visplanes[VisiblePlaneList::MAXVISPLANES];
+		VisiblePlane *pl = portalplanes;
 		if (pl)
 		{
-			visplanes[VisiblePlaneList::MAXVISPLANES] = pl->next;
+			portalplanes = pl->next;
 			pl->next = nullptr;
 		}
 		return pl;
@@ -327,7 +400,7 @@ namespace swrenderer
 
 	void VisiblePlaneList::ClearPortalPlanes()
 	{
-		visplanes[VisiblePlaneList::MAXVISPLANES] = nullptr;
+		portalplanes = nullptr;
 	}
 
 	int VisiblePlaneList::Render()
@@ -336,14 +409,20 @@ namespace swrenderer
 			PlaneCycles.Clock();
 
 		VisiblePlane *pl;
-		int i;
 		int vpcount = 0;
 
 		RenderPortal *renderportal = Thread->Portal.get();
 
-		for (i = 0; i < MAXVISPLANES; i++)
+		if (Thread->MainThread)
 		{
-			for (pl = visplanes[i]; pl; pl = pl->next)
+			visplanestats.planes = numplanes;
+			visplanestats.keys = usedslots.Size();
+			visplanestats.slots = slots.Size();
+		}
+
+		for (unsigned index : usedslots)
+		{
+			for (pl = slots[index].planes; pl; pl = pl->next)
 			{
 				// kg3D - draw only correct planes
 				if (pl->CurrentPortalUniq != renderportal->CurrentPortalUniq || pl->CurrentSkybox != Thread->Clip3D->CurrentSkybox)
@@ -365,16 +444,15 @@ namespace swrenderer
 	void VisiblePlaneList::RenderHeight(double height)
 	{
 		VisiblePlane *pl;
-		int i;
 
 		DVector3 oViewPos = Thread->Viewport->viewpoint.Pos;
 		DAngle oViewAngle = Thread->Viewport->viewpoint.Angles.Yaw;
 		
 		RenderPortal *renderportal = Thread->Portal.get();
 
-		for (i = 0; i < MAXVISPLANES; i++)
+		for (unsigned index : usedslots)
 		{
-			for (pl = visplanes[i]; pl; pl = pl->next)
+			for (pl = slots[index].planes; pl; pl = pl->next)
 			{
 				if (pl->CurrentSkybox != Thread->Clip3D->CurrentSkybox || pl->CurrentPortalUniq != renderportal->CurrentPortalUniq)
 					continue;
@@ -392,4 +470,14 @@ namespace swrenderer
 		Thread->Viewport->viewpoint.Pos = oViewPos;
 		Thread->Viewport->viewpoint.Angles.Yaw = oViewAngle;
 	}
+
+	ADD_STAT(visplanes)
+	{
+		FString out;
+		out.Format("visplanes=%d  keys=%d  slots=%d  load=%.2f  longest probe=%d",
+			visplanestats.planes, visplanestats.keys, visplanestats.slots,
+			visplanestats.slots ? (double)visplanestats.keys / visplanestats.slots : 0.0, visplanestats.maxprobe);
+		visplanestats.maxprobe = 0;
+		return out;
+	}
 }
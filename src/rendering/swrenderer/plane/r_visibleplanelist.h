@@ -53,12 +53,32 @@ namespace swrenderer
 		RenderThread *Thread = nullptr;
 
 	private:
+		// Open addressing table with linear probing. Each slot holds every visplane with the
+		// same full hash value, so planes split by GetRange stay together in one slot.
+		struct Slot
+		{
+			unsigned hash;
+			bool used;
+			VisiblePlane *planes;
+		};
+
 		VisiblePlaneList();
 		VisiblePlane *Add(unsigned hash);
+		VisiblePlane *AddPortalPlane();
+		Slot &FindSlot(unsigned hash);
+		void Grow();
 
-		enum { MAXVISPLANES = 128 }; // must be a power of 2
-		VisiblePlane *visplanes[MAXVISPLANES + 1];
+		enum { MINSLOTS = 128 }; // must be a power of 2
+		TArray<Slot> slots;
+		TArray<unsigned> usedslots;		// In order of first use, so Render does not depend on the table size
+		VisiblePlane *portalplanes = nullptr;
+		int numplanes = 0;
 
-		static unsigned CalcHash(int picnum, int lightlevel, const secplane_t &height) { return (unsigned)((picnum) * 3 + (lightlevel)+(FLOAT2FIXED((height).fD())) * 7) & (MAXVISPLANES - 1); }
+		static unsigned CalcHash(int picnum, int lightlevel, const secplane_t &height)
+		{
+			unsigned hash = (unsigned)((picnum) * 3 + (lightlevel)+(FLOAT2FIXED((height).fD())) * 7);
+			hash = (hash ^ (hash >> 16)) * 0x45d9f3b;
+			return hash ^ (hash >> 16);
+		}
 	};
 }
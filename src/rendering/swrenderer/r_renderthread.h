@@ -24,6 +24,7 @@
 
 #include <memory>
 #include <thread>
+#include <atomic>
 
 class RenderMemory;
 struct FDynamicLight;
@@ -61,6 +62,10 @@ namespace swrenderer
 		int X2 = MAXWIDTH;
 		bool MainThread = false;
 
+		// Column bands still to be rendered by this thread, first in the upper and end in the lower 16 bits.
+		// Other threads take bands from the end once they run out of their own.
+		std::atomic<uint32_t> Bands{};
+
 		std::unique_ptr<RenderMemory> FrameMemory;
 		std::unique_ptr<RenderOpaquePass> OpaquePass;
 		std::unique_ptr<RenderTranslucentPass> TranslucentPass;
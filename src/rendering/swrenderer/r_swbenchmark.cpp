@@ -0,0 +1,240 @@
+//-----------------------------------------------------------------------------
+//
+// Copyright 2024 GZDoom Maintainers and Contributors
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see http://www.gnu.org/licenses/
+//
+//-----------------------------------------------------------------------------
+//
+// DESCRIPTION:
+//		Offscreen software renderer benchmark. Renders a fixed camera path
+//		into a canvas of its own, reports the time spent in each pass and
+//		compares the frames against a golden file.
+//
+//-----------------------------------------------------------------------------
+
+#include "r_swrenderer.h"
+#include "swrenderer/scene/r_scene.h"
+#include "doomstat.h"
+#include "d_player.h"
+#include "g_levellocals.h"
+#include "r_utility.h"
+#include "v_video.h"
+#include "v_palette.h"
+#include "m_png.h"
+#include "m_crc32.h"
+#include "files.h"
+#include "c_dispatch.h"
+#include "printf.h"
+#include "engineerrors.h"
+
+extern FRenderer *SWRenderer;
+
+struct FSWBenchFrame
+{
+	double FrameMS;
+	double OpaqueMS;
+	double PlaneMS;
+	double TranslucentMS;
+	double SpriteMS;
+	uint32_t CRC;
+};
+
+//==========================================================================
+//
+//
+//
+//==========================================================================
+
+static uint32_t CanvasCRC(DCanvas *canvas)
+{
+	int pixelsize = canvas->IsBgra() ? 4 : 1;
+	const uint8_t *pixels = canvas->GetPixels();
+	uint32_t crc = 0;
+	for (int y = 0; y < canvas->GetHeight(); y++)
+	{
+		crc = AddCRC32(crc, pixels + y * canvas->GetPitch() * pixelsize, canvas->GetWidth() * pixelsize);
+	}
+	return crc;
+}
+
+static void WriteFramePNG(DCanvas *canvas, const FString &filename)
+{
+	FileWriter *fw = FileWriter::Open(filename.GetChars());
+	if (fw == nullptr)
+	{
+		Printf(PRINT_HIGH, "Unable to write %s\n", filename.GetChars());
+		return;
+	}
+	int pixelsize = canvas->IsBgra() ? 4 : 1;
+	M_CreatePNG(fw, canvas->GetPixels(), GPalette.BaseColors, canvas->IsBgra() ? SS_BGRA : SS_PAL, canvas->GetWidth(), canvas->GetHeight(), canvas->GetPitch() * pixelsize, 1.f);
+	M_FinishPNG(fw);
+	delete fw;
+}
+
+// The golden file has one "frame crc" pair per line, all in hex.
+static bool ReadGoldenFile(const char *filename, TArray<uint32_t> &crcs)
+{
+	FileReader fr;
+	if (!fr.OpenFile(filename))
+		return false;
+
+	auto data = fr.ReadPadded(1);
+	FString text = data.string();
+	for (auto &line : text.Split("\n", FString::TOK_SKIPEMPTY))
+	{
+		unsigned frame, crc;
+		if (sscanf(line.GetChars(), "%x %x", &frame, &crc) == 2)
+		{
+			if (frame >= crcs.Size())
+				crcs.Resize(frame + 1);
+			crcs[frame] = crc;
+		}
+	}
+	return true;
+}
+
+static void WriteGoldenFile(const char *filename, const TArray<FSWBenchFrame> &frames)
+{
+	FileWriter *fw = FileWriter::Open(filename);
+	if (fw == nullptr)
+	{
+		Printf(PRINT_HIGH, "Unable to write %s\n", filename);
+		return;
+	}
+	for (unsigned i = 0; i < frames.Size(); i++)
+	{
+		fw->Printf("%04x %08x\n", i, frames[i].CRC);
+	}
+	delete fw;
+}
+
+//==========================================================================
+//
+// swbench <frames> [golden file] [update] [exit]
+//
+// Turns the console player's camera a full circle in place over the given
+// number of frames and renders each one offscreen at the current screen
+// size. The world is not ticked in between, so the frames only depend on
+// the level, the camera and the renderer settings.
+//
+// With a golden file every frame is checked against the CRC stored for it
+// and mismatching frames are saved next to the golden file as PNGs.
+// 'update' writes the golden file instead. 'exit' quits afterwards with
+// exit code 1 if any frame did not match, for use from a CI script.
+// With -novideo this needs neither a display nor a GPU, and -width and
+// -height set the size of the frames:
+//
+//	gzdoom -novideo -width 640 -height 400 +map MAP01 +wait 2 +"swbench 64 map01.golden exit"
+//
+//==========================================================================
+
+CCMD(swbench)
+{
+	if (argv.argc() < 2)
+	{
+		Printf("Usage: swbench <frames> [golden file] [update] [exit]\n");
+		return;
+	}
+	if (gamestate != GS_LEVEL || players[consoleplayer].mo == nullptr || SWRenderer == nullptr)
+	{
+		Printf("swbench needs a running level\n");
+		return;
+	}
+
+	int numframes = clamp((int)strtol(argv[1], nullptr, 0), 1, 3600);
+	const char *goldenname = argv.argc() > 2 ? argv[2] : nullptr;
+	bool update = false, exitafter = false;
+	for (int i = 3; i < argv.argc(); i++)
+	{
+		if (!stricmp(argv[i], "update")) update = true;
+		else if (!stricmp(argv[i], "exit")) exitafter = true;
+	}
+
+	TArray<uint32_t> golden;
+	if (goldenname && !update && !ReadGoldenFile(goldenname, golden))
+	{
+		Printf(PRINT_HIGH, "Unable to read golden file %s\n", goldenname);
+		if (exitafter) throw CExitEvent(1);
+		return;
+	}
+
+	player_t *player = &players[consoleplayer];
+	AActor *camera = player->camera ? player->camera.Get() : player->mo;
+	DRotator savedangles = camera->Angles;
+	DRotator savedprevangles = camera->PrevAngles;
+	bool savednointerpolate = r_NoInterpolate;
+	r_NoInterpolate = true;
+
+	DCanvas canvas(screen->GetWidth(), screen->GetHeight(), V_IsTrueColor());
+	auto renderer = static_cast<FSoftwareRenderer *>(SWRenderer);
+
+	TArray<FSWBenchFrame> frames;
+	int mismatches = 0;
+	for (int i = 0; i < numframes; i++)
+	{
+		camera->Angles.Yaw = savedangles.Yaw + DAngle::fromDeg(360.0 * i / numframes);
+		camera->PrevAngles = camera->Angles;
+
+		cycle_t framecycles;
+		framecycles.Reset();
+		framecycles.Clock();
+		renderer->RenderOffscreen(camera, &canvas);
+		framecycles.Unclock();
+
+		auto &frame = frames[frames.Reserve(1)];
+		frame.FrameMS = framecycles.TimeMS();
+		frame.OpaqueMS = swrenderer::WallCycles.TimeMS();
+		frame.PlaneMS = swrenderer::PlaneCycles.TimeMS();
+		frame.SpriteMS = swrenderer::SpriteCycles.TimeMS();
+		frame.TranslucentMS = swrenderer::MaskedCycles.TimeMS() - frame.SpriteMS;
+		frame.CRC = CanvasCRC(&canvas);
+
+		if (goldenname && !update && ((unsigned)i >= golden.Size() || golden[i] != frame.CRC))
+		{
+			mismatches++;
+			WriteFramePNG(&canvas, FStringf("%s.%04d.png", goldenname, i));
+		}
+	}
+
+	camera->Angles = savedangles;
+	camera->PrevAngles = savedprevangles;
+	r_NoInterpolate = savednointerpolate;
+
+	double total[5] = {};
+	for (auto &frame : frames)
+	{
+		total[0] += frame.FrameMS;
+		total[1] += frame.OpaqueMS;
+		total[2] += frame.PlaneMS;
+		total[3] += frame.TranslucentMS;
+		total[4] += frame.SpriteMS;
+	}
+	Printf("Rendered %d frames at %dx%d%s\n", numframes, canvas.GetWidth(), canvas.GetHeight(), canvas.IsBgra() ? " truecolor" : "");
+	Printf("frame=%.3f ms  opaque=%.3f ms  planes=%.3f ms  translucent=%.3f ms  sprites=%.3f ms\n",
+		total[0] / numframes, total[1] / numframes, total[2] / numframes, total[3] / numframes, total[4] / numframes);
+
+	if (goldenname && update)
+	{
+		WriteGoldenFile(goldenname, frames);
+		Printf("Golden file %s written\n", goldenname);
+	}
+	else if (goldenname)
+	{
+		if (mismatches == 0) Printf("All frames match %s\n", goldenname);
+		else Printf(PRINT_HIGH, TEXTCOLOR_RED "%d of %d frames differ from %s\n", mismatches, numframes, goldenname);
+	}
+
+	if (exitafter) throw CExitEvent(mismatches > 0 ? 1 : 0);
+}
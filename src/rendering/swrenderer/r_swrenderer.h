@@ -26,6 +26,9 @@ struct FSoftwareRenderer : public FRenderer
 	void SetColormap(FLevelLocals *Level) override;
 	void Init() override;
 
+	// renders the view of an actor into an offscreen canvas (used by swbench)
+	void RenderOffscreen(AActor *viewpoint, DCanvas *canvas);
+
 private:
 	void PreparePrecache(FGameTexture *tex, int cache);
 	void PrecacheTexture(FGameTexture *tex, int cache);
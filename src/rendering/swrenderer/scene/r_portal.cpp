@@ -108,6 +108,7 @@ namespace swrenderer
 		if (!planes->HasPortalPlanes())
 			return;
 
+		ViewChanged = true;
 		Thread->Clip3D->EnterSkybox();
 		CurrentPortalInSkybox = true;
 
@@ -268,6 +269,7 @@ namespace swrenderer
 		// [RH] Walk through mirrors
 		// [ZZ] Merged with portals
 		size_t lastportal = WallPortals.Size();
+		if (lastportal > 0) ViewChanged = true;
 		for (unsigned int i = 0; i < lastportal; i++)
 		{
 			RenderLinePortal(WallPortals[i], 0);
@@ -537,6 +539,7 @@ namespace swrenderer
 		CurrentPortalUniq = 0;
 		WallPortals.Clear();
 		SectorPortalsInSkyBox.clear();
+		ViewChanged = false;
 	}
 
 	void RenderPortal::AddLinePortal(line_t *linedef, int x1, int x2, const short *topclip, const short *bottomclip)
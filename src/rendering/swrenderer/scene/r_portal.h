@@ -67,6 +67,9 @@ namespace swrenderer
 		
 		int numskyboxes = 0; // For ADD_STAT(skyboxes)
 
+		// Set when portals were rendered since SetMainPortal. They do not restore every part of the viewport.
+		bool ViewChanged = false;
+
 		void SetInSkyBox(FSectorPortal *portal) { SectorPortalsInSkyBox.insert(portal); }
 		void ClearInSkyBox(FSectorPortal *portal) { SectorPortalsInSkyBox.erase(portal); }
 		bool InSkyBox(FSectorPortal *portal) const { return SectorPortalsInSkyBox.find(portal) != SectorPortalsInSkyBox.end(); }
@@ -63,15 +63,18 @@ EXTERN_CVAR(Int, r_clearbuffer)
 EXTERN_CVAR(Int, r_debug_draw)
 
 CVAR(Int, r_scene_multithreaded, 1, 0);
+CVAR(Int, r_scene_bands, 4, 0);	// column bands per thread, more allow idle threads to take over work
 CVAR(Bool, r_models, true, CVAR_ARCHIVE | CVAR_GLOBALCONFIG);
 
 namespace swrenderer
 {
-	cycle_t WallCycles, PlaneCycles, MaskedCycles;
+	cycle_t WallCycles, PlaneCycles, MaskedCycles, SpriteCycles;
 	
 	RenderScene::RenderScene()
 	{
 		Threads.push_back(std::unique_ptr<RenderThread>(new RenderThread(this)));
+		BandViewport.reset(new RenderViewport());
+		BandLight.reset(new LightVisibility());
 	}
 
 	RenderScene::~RenderScene()
@@ -131,6 +134,7 @@ namespace swrenderer
 		WallCycles.Reset();
 		PlaneCycles.Reset();
 		MaskedCycles.Reset();
+		SpriteCycles.Reset();
 		
 		R_SetupFrame(MainThread()->Viewport->viewpoint, MainThread()->Viewport->viewwindow, actor);
 
@@ -186,17 +190,30 @@ namespace swrenderer
 			StartThreads(numThreads);
 		}
 
+		// Split the view into r_scene_bands column bands per thread. Each thread starts with an
+		// even share of neighbouring bands and steals from the others when it runs out of its own.
+		// Every band is a separate BSP traversal, so a view with evenly spread cost gets a bit slower
+		// with more bands, but one where a few columns carry most of the work gets a lot faster.
+		NumBands = 1;
+		if (numThreads > 1)
+		{
+			NumBands = clamp(numThreads * max(*r_scene_bands, 1), numThreads, max(viewwidth / 16, numThreads));
+			NumBands = min(NumBands, 0xffff);
+		}
+
 		// Setup threads:
 		std::unique_lock<std::mutex> start_lock(start_mutex);
+		*BandViewport = *MainThread()->Viewport;
+		*BandLight = *MainThread()->Light;
 		for (int i = 0; i < numThreads; i++)
 		{
-			*Threads[i]->Viewport = *MainThread()->Viewport;
-			*Threads[i]->Light = *MainThread()->Light;
-			Threads[i]->X1 = viewwidth * i / numThreads;
-			Threads[i]->X2 = viewwidth * (i + 1) / numThreads;
+			uint32_t first = NumBands * i / numThreads;
+			uint32_t end = NumBands * (i + 1) / numThreads;
+			Threads[i]->Bands = (first << 16) | end;
 		}
 		run_id++;
 		FSoftwareTexture::CurrentUpdate = run_id;
+		FSoftwareTexture::TrimCache();
 		start_lock.unlock();
 
 		// Notify threads to run
@@ -206,7 +223,7 @@ namespace swrenderer
 		}
 
 		// Do the main thread ourselves:
-		RenderThreadSlice(MainThread());
+		RenderThreadBands(MainThread());
 
 		// Wait for everyone to finish:
 		if (Threads.size() > 1)
@@ -226,12 +243,81 @@ namespace swrenderer
 		MainThread()->X2 = viewwidth;
 	}
 
+	static bool TakeBand(std::atomic<uint32_t> &bands, bool steal, int &band)
+	{
+		uint32_t range = bands;
+		while (true)
+		{
+			uint32_t first = range >> 16;
+			uint32_t end = range & 0xffff;
+			if (first >= end)
+				return false;
+
+			uint32_t newrange = steal ? (first << 16) | (end - 1) : ((first + 1) << 16) | end;
+			if (bands.compare_exchange_weak(range, newrange))
+			{
+				band = steal ? end - 1 : first;
+				return true;
+			}
+		}
+	}
+
+	bool RenderScene::NextBand(RenderThread *thread, int &band)
+	{
+		if (TakeBand(thread->Bands, false, band))
+			return true;
+
+		// Steal from whoever has the most work left.
+		while (true)
+		{
+			RenderThread *victim = nullptr;
+			uint32_t mostleft = 0;
+			for (auto &other : Threads)
+			{
+				uint32_t range = other->Bands;
+				uint32_t first = range >> 16;
+				uint32_t end = range & 0xffff;
+				if (end > first && end - first > mostleft)
+				{
+					victim = other.get();
+					mostleft = end - first;
+				}
+			}
+			if (!victim)
+				return false;
+			if (TakeBand(victim->Bands, true, band))
+				return true;
+		}
+	}
+
+	void RenderScene::RenderThreadBands(RenderThread *thread)
+	{
+		// The view state is set up once per frame. Portals may leave it changed, in which case the
+		// next band has to start from a fresh copy.
+		*thread->Viewport = *BandViewport;
+		*thread->Light = *BandLight;
+		thread->Portal->CopyStackedViewParameters();
+
+		int band;
+		while (NextBand(thread, band))
+		{
+			if (thread->Portal->ViewChanged)
+			{
+				*thread->Viewport = *BandViewport;
+				*thread->Light = *BandLight;
+			}
+			thread->X1 = viewwidth * band / NumBands;
+			thread->X2 = viewwidth * (band + 1) / NumBands;
+			RenderThreadSlice(thread);
+		}
+	}
+
 	void RenderScene::RenderThreadSlice(RenderThread *thread)
 	{
+		// Each band is a separate BSP traversal, so all the lists it fills have to start out empty.
 		thread->FrameMemory->Clear();
 		thread->Clip3D->Cleanup();
 		thread->Clip3D->ResetClip(); // reset clips (floor/ceiling)
-		thread->Portal->CopyStackedViewParameters();
 		thread->ClipSegments->Clear(0, viewwidth);
 		thread->DrawSegments->Clear();
 		thread->PlaneList->Clear();
@@ -313,7 +399,7 @@ namespace swrenderer
 					last_run_id = run_id;
 					start_lock.unlock();
 
-					RenderThreadSlice(renderthread);
+					RenderThreadBands(renderthread);
 
 					// Notify main thread that we finished:
 					std::unique_lock<std::mutex> end_lock(end_mutex);
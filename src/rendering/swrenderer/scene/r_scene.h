@@ -34,9 +34,11 @@ extern cycle_t FrameCycles;
 
 namespace swrenderer
 {
-	extern cycle_t WallCycles, PlaneCycles, MaskedCycles, DrawerWaitCycles;
+	extern cycle_t WallCycles, PlaneCycles, MaskedCycles, SpriteCycles, DrawerWaitCycles;
 
 	class RenderThread;
+	class RenderViewport;
+	class LightVisibility;
 	
 	class RenderScene
 	{
@@ -58,7 +60,9 @@ namespace swrenderer
 	private:
 		void RenderActorView(AActor *actor,bool renderplayersprite, bool dontmaplines);
 		void RenderThreadSlices();
+		void RenderThreadBands(RenderThread *thread);
 		void RenderThreadSlice(RenderThread *thread);
+		bool NextBand(RenderThread *thread, int &band);
 		void RenderPSprites();
 
 		void StartThreads(size_t numThreads);
@@ -68,6 +72,9 @@ namespace swrenderer
 		int clearcolor = 0;
 
 		std::vector<std::unique_ptr<RenderThread>> Threads;
+		std::unique_ptr<RenderViewport> BandViewport;
+		std::unique_ptr<LightVisibility> BandLight;
+		int NumBands = 1;
 		std::mutex start_mutex;
 		std::condition_variable start_condition;
 		bool shutdown_flag = false;
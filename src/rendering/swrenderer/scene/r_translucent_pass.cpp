@@ -136,6 +136,9 @@ namespace swrenderer
 		RenderPortal *renderportal = Thread->Portal.get();
 		DrawSegmentList *drawseglist = Thread->DrawSegments.get();
 
+		if (Thread->MainThread)
+			SpriteCycles.Clock();
+
 		auto &sortedSprites = Thread->SpriteList->SortedSprites;
 		for (int i = sortedSprites.Size(); i > 0; i--)
 		{
@@ -147,6 +150,9 @@ namespace swrenderer
 			}
 		}
 
+		if (Thread->MainThread)
+			SpriteCycles.Unclock();
+
 		// render any remaining masked mid textures
 
 		for (unsigned int index = 0; index != drawseglist->SegmentsCount(); index++)
@@ -39,7 +39,17 @@
 #include "m_alloc.h"
 #include "imagehelpers.h"
 #include "texturemanager.h"
+#include "c_cvars.h"
+#include "printf.h"
+#include "c_dispatch.h"
 #include <mutex>
+#include <algorithm>
+
+// Pixel data budget for the software renderer's textures in megabytes. 0 means unlimited.
+CVAR(Int, r_texturecache, 0, CVAR_ARCHIVE | CVAR_GLOBALCONFIG)
+
+static TArray<FSoftwareTexture *> CachedTextures;
+size_t FSoftwareTexture::CachedBytes;
 
 inline EUpscaleFlags scaleFlagFromUseType(ETextureType useType)
 {
@@ -199,6 +209,7 @@ void FSoftwareTexture::UpdatePixels(int index)
 	std::unique_lock<std::mutex> lock(swrenderer::loadmutex);
 	if (Unlockeddata[index].LastUpdate != CurrentUpdate)
 	{
+		AddToCache();
 		if (index != 2)
 		{
 			const uint8_t* Pixeldata = GetPixelsLocked(index);
@@ -215,7 +226,93 @@ void FSoftwareTexture::UpdatePixels(int index)
 			Unlockeddata[index].Pixels = Pixeldata;
 			Unlockeddata[index].LastUpdate = CurrentUpdate;
 		}
+		CachedBytes -= CacheSize;
+		CacheSize = PixelMemory();
+		CachedBytes += CacheSize;
+	}
+}
+
+//==========================================================================
+//
+// Pixel data cache
+//
+// Every texture that holds pixel data is registered here so that the
+// ones which were not used for a while can be unloaded when a texture
+// pack needs more memory than r_texturecache allows. Camera textures
+// are exempt since their pixels are rendered, not loaded.
+//
+//==========================================================================
+
+void FSoftwareTexture::AddToCache()
+{
+	if (CacheIndex < 0 && !mTexture->isSoftwareCanvas())
+	{
+		CacheIndex = CachedTextures.Push(this);
+	}
+}
+
+void FSoftwareTexture::RemoveFromCache()
+{
+	if (CacheIndex >= 0)
+	{
+		auto last = CachedTextures.Last();
+		CachedTextures[CacheIndex] = last;
+		last->CacheIndex = CacheIndex;
+		CachedTextures.Pop();
+		CacheIndex = -1;
 	}
+	CachedBytes -= CacheSize;
+	CacheSize = 0;
+}
+
+// Trimming goes down to this share of the budget so that it does not have
+// to run again as soon as the next texture gets loaded.
+static const size_t TrimLowWater = 3;	// in quarters of the budget
+
+// When recently used textures alone are over the budget, trimming cannot
+// make progress. It then waits for this many updates before trying again.
+static const unsigned TrimRetryDelay = 35;
+static int TrimFailedUpdate;
+static bool TrimFailed;
+
+void FSoftwareTexture::TrimCache()
+{
+	size_t budget = (size_t)max(*r_texturecache, 0) << 20;
+	if (budget == 0 || CachedBytes <= budget)
+		return;
+	if (TrimFailed && unsigned(CurrentUpdate - TrimFailedUpdate) < TrimRetryDelay)
+		return;
+
+	std::unique_lock<std::mutex> lock(swrenderer::loadmutex);
+	size_t lowwater = budget / 4 * TrimLowWater;
+
+	auto lastuse = [](FSoftwareTexture *tex) { return max(max(tex->Unlockeddata[0].LastUpdate, tex->Unlockeddata[1].LastUpdate), tex->Unlockeddata[2].LastUpdate); };
+
+	// Textures used by the last two updates may still be referenced by the scene setup code.
+	TArray<FSoftwareTexture *> candidates;
+	for (auto tex : CachedTextures)
+	{
+		if (lastuse(tex) < CurrentUpdate - 1)
+			candidates.Push(tex);
+	}
+	std::sort(candidates.begin(), candidates.end(), [&](FSoftwareTexture *a, FSoftwareTexture *b) { return lastuse(a) < lastuse(b); });
+
+	for (auto tex : candidates)
+	{
+		if (CachedBytes <= lowwater)
+			break;
+		tex->Unload();
+	}
+	TrimFailed = CachedBytes > budget;
+	TrimFailedUpdate = CurrentUpdate;
+}
+
+CCMD(r_texturecachestats)
+{
+	if (r_texturecache > 0)
+		Printf("%u textures, %.1f MB of pixel data (budget %d MB)\n", CachedTextures.Size(), FSoftwareTexture::CachedBytes / 1048576.0, *r_texturecache);
+	else
+		Printf("%u textures, %.1f MB of pixel data (no budget)\n", CachedTextures.Size(), FSoftwareTexture::CachedBytes / 1048576.0);
 }
 
 //==========================================================================
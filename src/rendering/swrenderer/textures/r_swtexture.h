@@ -32,8 +32,12 @@ protected:
 	int mPhysicalWidth, mPhysicalHeight;
 	int mPhysicalScale;
 	int mBufferFlags;
+	int CacheIndex = -1;	// Position in CachedTextures, -1 if the texture holds no pixel data
+	size_t CacheSize = 0;
 
 	void FreeAllSpans();
+	void AddToCache();
+	void RemoveFromCache();
 	template<class T> FSoftwareTextureSpan **CreateSpans(const T *pixels);
 	void FreeSpans(FSoftwareTextureSpan **spans);
 	void CalcBitSize();
@@ -43,6 +47,7 @@ public:
 	
 	virtual ~FSoftwareTexture()
 	{
+		RemoveFromCache();
 		FreeAllSpans();
 	}
 
@@ -97,10 +102,17 @@ public:
 	
 	virtual void Unload()
 	{
+		RemoveFromCache();
 		Pixels.Reset();
 		PixelsBgra.Reset();
 		for (auto& d : Unlockeddata) d = {};
 	}
+
+	// Bytes of pixel data this texture currently holds, as counted against the r_texturecache budget.
+	virtual size_t PixelMemory() const
+	{
+		return Pixels.Size() + PixelsBgra.Size() * sizeof(uint32_t);
+	}
 	
 	// Returns true if the next call to GetPixels() will return an image different from the
 	// last call to GetPixels(). This should be considered valid only if a call to CheckModified()
@@ -201,6 +213,11 @@ public:
 	static int CurrentUpdate;
 	void UpdatePixels(int style);
 
+	// Unloads the least recently used textures when the pixel data is over the r_texturecache budget, down to 3/4 of it.
+	// Must only be called while no render thread is running.
+	static void TrimCache();
+	static size_t CachedBytes;
+
 	virtual const uint32_t* GetPixelsBgraLocked();
 	virtual const uint8_t* GetPixelsLocked(int style);
 };
@@ -221,6 +238,8 @@ public:
 	const uint32_t *GetPixelsBgraLocked() override;
 	const uint8_t *GetPixelsLocked(int style) override;
 	bool CheckModified (int which) override;
+	void Unload() override;
+	size_t PixelMemory() const override;
 	void GenerateBgraMipmapsFast();
 
 private:
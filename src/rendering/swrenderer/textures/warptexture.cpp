@@ -97,6 +97,19 @@ const uint8_t *FWarpTexture::GetPixelsLocked(int index)
 	return WarpedPixels[index].Data();
 }
 
+void FWarpTexture::Unload()
+{
+	for (auto &pix : WarpedPixels) pix.Reset();
+	WarpedPixelsRgba.Reset();
+	for (auto &time : GenTime) time = UINT64_MAX;
+	FSoftwareTexture::Unload();
+}
+
+size_t FWarpTexture::PixelMemory() const
+{
+	return FSoftwareTexture::PixelMemory() + WarpedPixels[0].Size() + WarpedPixels[1].Size() + WarpedPixelsRgba.Size() * sizeof(uint32_t);
+}
+
 // [mxd] Non power of 2 textures need different offset multipliers, otherwise warp animation won't sync across texture
 void FWarpTexture::SetupMultipliers (int width, int height)
 {